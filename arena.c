@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGNMENT sizeof(void *) // every allocation is aligned for pointers
+#define ARENA_MAX_BLOCK_SIZE ((size_t) 16 << 20) // blocks stop doubling in size at 16MB
+
+
+/**
+ * A function to set up an empty arena, no memory is allocated until it is first needed
+ * @param arena The arena to set up
+ * @param blockSize The size of the first block in bytes, later blocks double in size
+ */
+void initArena (struct Arena *arena, size_t blockSize) {
+    arena->blocks = 0;
+    arena->current = 0;
+    arena->cursor = 0;
+    arena->remaining = 0;
+    arena->blockSize = blockSize > 0 ? blockSize : 4096;
+}
+
+/**
+ * A function to allocate memory from an arena, a new block is allocated when the current one is full
+ * @param arena The arena to allocate from
+ * @param size The number of bytes needed
+ * @return A pointer to the memory, aligned for pointers
+ */
+void* arenaAllocate (struct Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1); // round up so the next allocation stays aligned
+
+    if (size > arena->remaining) { // the current block is full so start a new one
+        size_t blockSize = arena->blockSize > size ? arena->blockSize : size; // oversized allocations get their own block
+        struct ArenaBlock *block = malloc(sizeof(struct ArenaBlock) + blockSize);
+        block->next = 0;
+        block->size = blockSize;
+        block->used = 0;
+        if (arena->current != 0) {
+            arena->current->next = block;
+        } else {
+            arena->blocks = block;
+        }
+        arena->current = block;
+        arena->cursor = block->data;
+        arena->remaining = blockSize;
+        if (arena->blockSize < ARENA_MAX_BLOCK_SIZE) {
+            arena->blockSize *= 2; // fewer, larger blocks as the arena grows
+        }
+    }
+
+    void *memory = arena->cursor;
+    arena->cursor += size;
+    arena->remaining -= size;
+    arena->current->used += size;
+    return memory;
+}
+
+/**
+ * A function to copy a string into an arena
+ * @param arena The arena to copy into
+ * @param str The string to copy, doesn't need to be null terminated
+ * @param length The length of the string in bytes
+ * @return The null terminated copy
+ */
+char* arenaCopyString (struct Arena *arena, const char *str, size_t length) {
+    char *copy = arenaAllocate(arena, length + 1);
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+/**
+ * A function to free every block of an arena at once, the arena is left empty and can be used again
+ * @param arena The arena to release
+ */
+void releaseArena (struct Arena *arena) {
+    struct ArenaBlock *block = arena->blocks;
+    while (block != 0) {
+        struct ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = 0;
+    arena->current = 0;
+    arena->cursor = 0;
+    arena->remaining = 0;
+}
+
+/**
+ * A function to move every block of one arena onto the end of another, so memory handed out by both is released
+ * together. Whatever was left of the destination's current block is no longer handed out. The arena moved from is left
+ * empty.
+ * @param destination The arena to move the blocks into
+ * @param source The arena to move the blocks out of
+ */
+void mergeArena (struct Arena *destination, struct Arena *source) {
+    if (source->blocks == 0) return; // nothing to move
+    if (destination->blocks == 0) {
+        *destination = *source;
+    } else { // put the source's blocks after the destination's and carry on allocating from the source's current block
+        destination->current->next = source->blocks;
+        destination->current = source->current;
+        destination->cursor = source->cursor;
+        destination->remaining = source->remaining;
+        if (source->blockSize > destination->blockSize) {
+            destination->blockSize = source->blockSize;
+        }
+    }
+    initArena(source, source->blockSize);
+}
+
+/**
+ * A function to set up an empty pool of fixed-size nodes
+ * @param pool The pool to set up
+ * @param nodeSize The size of each node in bytes, at least the size of a pointer
+ * @param nodesPerBlock The number of nodes the first block of the pool holds
+ */
+void initNodePool (struct NodePool *pool, size_t nodeSize, size_t nodesPerBlock) {
+    if (nodeSize < sizeof(void *)) {
+        nodeSize = sizeof(void *); // free nodes need room to hold the free list pointer
+    }
+    pool->nodeSize = (nodeSize + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    pool->freeList = 0;
+    initArena(&pool->arena, pool->nodeSize * nodesPerBlock);
+}
+
+/**
+ * A function to get a node from a pool, reusing a freed node if there is one
+ * @param pool The pool to get the node from
+ * @return A pointer to the node, its contents are undefined
+ */
+void* poolAllocate (struct NodePool *pool) {
+    if (pool->freeList != 0) {
+        void *node = pool->freeList;
+        pool->freeList = *(void **) node; // the next free node is stored in the first bytes of this one
+        return node;
+    }
+    return arenaAllocate(&pool->arena, pool->nodeSize);
+}
+
+/**
+ * A function to give a node back to the pool it came from so it can be handed out again
+ * @param pool The pool the node came from
+ * @param node The node to give back
+ */
+void poolFree (struct NodePool *pool, void *node) {
+    *(void **) node = pool->freeList;
+    pool->freeList = node;
+}
+
+/**
+ * A function to free every node of a pool at once, the pool is left empty and can be used again
+ * @param pool The pool to release
+ */
+void releaseNodePool (struct NodePool *pool) {
+    releaseArena(&pool->arena);
+    pool->freeList = 0;
+}
+
+/**
+ * A function to move every node of one pool into another, so nodes handed out by both are released together and
+ * freed nodes of either can be reused by the destination. The pools must have the same node size and the pool moved
+ * from is left empty.
+ * @param destination The pool to move the nodes into
+ * @param source The pool to move the nodes out of
+ */
+void mergeNodePool (struct NodePool *destination, struct NodePool *source) {
+    mergeArena(&destination->arena, &source->arena);
+    if (source->freeList != 0) { // put the source's free nodes in front of the destination's
+        void *last = source->freeList;
+        while (*(void **) last != 0) {
+            last = *(void **) last;
+        }
+        *(void **) last = destination->freeList;
+        destination->freeList = source->freeList;
+        source->freeList = 0;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+
+/**
+ * ArenaBlock struct, one large allocation that an arena hands memory out of
+ */
+struct ArenaBlock {
+    struct ArenaBlock *next; // holds a pointer to the block allocated after this one
+    size_t size; // holds the number of bytes that can be handed out of this block
+    size_t used; // holds the number of bytes that have been handed out of this block
+    char data[]; // holds the memory handed out
+};
+
+/**
+ * Arena struct, hands out memory by bumping a cursor through large blocks. Nothing is freed on its own, every block
+ * is released at once when the arena is. The blocks are kept in the order they were allocated, so walking them visits
+ * memory in the order it was handed out.
+ */
+struct Arena {
+    struct ArenaBlock *blocks; // holds the first block allocated, which links to the later ones
+    struct ArenaBlock *current; // holds the most recently allocated block, the one memory is handed out of
+    char *cursor; // holds the next free byte in the current block
+    size_t remaining; // holds the number of free bytes left in the current block
+    size_t blockSize; // holds the size of the next block to allocate, doubling up to a limit
+};
+
+/**
+ * NodePool struct, hands out fixed-size nodes from an arena and keeps the nodes given back in a free list to be
+ * handed out again
+ */
+struct NodePool {
+    struct Arena arena; // holds the arena the nodes are carved out of
+    size_t nodeSize; // holds the size of each node in bytes
+    void *freeList; // holds the most recently freed node, each free node holds a pointer to the next
+};
+
+void initArena (struct Arena *arena, size_t blockSize);
+void* arenaAllocate (struct Arena *arena, size_t size);
+char* arenaCopyString (struct Arena *arena, const char *str, size_t length);
+void releaseArena (struct Arena *arena);
+void mergeArena (struct Arena *destination, struct Arena *source);
+void initNodePool (struct NodePool *pool, size_t nodeSize, size_t nodesPerBlock);
+void* poolAllocate (struct NodePool *pool);
+void poolFree (struct NodePool *pool, void *node);
+void releaseNodePool (struct NodePool *pool);
+void mergeNodePool (struct NodePool *destination, struct NodePool *source);
+
+#endif // ARENA_H
@@ -0,0 +1,605 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arena.h"
+#include "compacthashtable.h"
+#include "hashtable.h"
+#include "loader.h"
+#include "openhashtable.h"
+#include "swisshashtable.h"
+
+#define BENCH_LATENCY_BATCH 32 // operations timed together for each latency sample, a clock read per operation would cost more than most operations
+#define BENCH_MIN_OPERATIONS (1 << 20) // lookup workloads run at least this many operations so small tables are timed for long enough
+#define BENCH_ZIPF_THETA 0.99 // the skew of the Zipfian distribution, the same as YCSB's default
+
+
+/**
+ * BenchEngine struct, one table implementation put behind the same calls so every engine runs the same workloads
+ */
+struct BenchEngine {
+    const char *name; // holds the name the results are reported under
+    void* (*construct) (HashFunction hashFunction); // creates an empty table
+    void (*add) (void *table, char *key, uint32_t keyLength, int value); // adds a key
+    int (*search) (void *table, char *key, uint32_t keyLength); // looks a key up, returning whether it was found
+    void (*remove) (void *table, char *key, uint32_t keyLength); // removes a key
+    void (*destroy) (void *table); // frees the table
+};
+
+/**
+ * BenchKeys struct, a set of keys to benchmark with, all stored in one arena
+ */
+struct BenchKeys {
+    char **keys; // holds the keys
+    uint32_t *lengths; // holds the length of each key
+    long count; // holds the number of keys
+    struct Arena storage; // holds the bytes of every key
+};
+
+/**
+ * BenchRandom struct, the state of a splitmix64 generator so every run draws the same keys
+ */
+struct BenchRandom {
+    uint64_t state; // holds the state, advanced on every draw
+};
+
+/**
+ * BenchZipf struct, a Zipfian distribution over ranks in [0, n) using the method from YCSB, after Gray et al.
+ * Jim Gray et al., 1994. Quickly generating billion-record synthetic databases. SIGMOD '94.
+ */
+struct BenchZipf {
+    long n; // holds the number of ranks
+    double theta; // holds the skew
+    double alpha; // holds 1 / (1 - theta)
+    double zetaN; // holds the sum of 1 / i^theta for i from 1 to n
+    double eta; // holds the correction used for ranks past the first two
+};
+
+/**
+ * The calls of the chained engine, the chained HashTable, growing from its default options
+ */
+void* constructChainedEngine (HashFunction hashFunction) {
+    struct HashTableOptions options = defaultHashTableOptions();
+    options.hashFunction = hashFunction;
+    return constructHashTableWithOptions(&options);
+}
+
+void addChainedEngine (void *table, char *key, uint32_t keyLength, int value) {
+    addToTableWithLength(table, key, keyLength, value);
+}
+
+int searchChainedEngine (void *table, char *key, uint32_t keyLength) {
+    return searchTableWithLength(table, key, keyLength) != 0;
+}
+
+void removeChainedEngine (void *table, char *key, uint32_t keyLength) {
+    removeFromTableWithLength(table, key, keyLength);
+}
+
+void destroyChainedEngine (void *table) {
+    destroyHashTable(table);
+}
+
+/**
+ * The calls of the open engine, OpenHashTable, growing from 16 slots
+ */
+void* constructOpenEngine (HashFunction hashFunction) {
+    return constructOpenHashTable(16, 0, hashFunction);
+}
+
+void addOpenEngine (void *table, char *key, uint32_t keyLength, int value) {
+    addToOpenTableWithLength(table, key, keyLength, value);
+}
+
+int searchOpenEngine (void *table, char *key, uint32_t keyLength) {
+    return searchOpenTableWithLength(table, key, keyLength) != 0;
+}
+
+void removeOpenEngine (void *table, char *key, uint32_t keyLength) {
+    removeFromOpenTableWithLength(table, key, keyLength);
+}
+
+void destroyOpenEngine (void *table) {
+    destroyOpenHashTable(table);
+}
+
+/**
+ * The calls of the swiss engine, SwissHashTable, growing from 16 slots
+ */
+void* constructSwissEngine (HashFunction hashFunction) {
+    return constructSwissHashTable(16, 0, hashFunction);
+}
+
+void addSwissEngine (void *table, char *key, uint32_t keyLength, int value) {
+    addToSwissTableWithLength(table, key, keyLength, value);
+}
+
+int searchSwissEngine (void *table, char *key, uint32_t keyLength) {
+    return searchSwissTableWithLength(table, key, keyLength) != 0;
+}
+
+void removeSwissEngine (void *table, char *key, uint32_t keyLength) {
+    removeFromSwissTableWithLength(table, key, keyLength);
+}
+
+void destroySwissEngine (void *table) {
+    destroySwissHashTable(table);
+}
+
+/**
+ * The calls of the compact engine, CompactHashTable, growing from 16 buckets
+ */
+void* constructCompactEngine (HashFunction hashFunction) {
+    return constructCompactHashTable(16, 0, hashFunction);
+}
+
+void addCompactEngine (void *table, char *key, uint32_t keyLength, int value) {
+    addToCompactTableWithLength(table, key, keyLength, value);
+}
+
+int searchCompactEngine (void *table, char *key, uint32_t keyLength) {
+    return searchCompactTableWithLength(table, key, keyLength) != 0;
+}
+
+void removeCompactEngine (void *table, char *key, uint32_t keyLength) {
+    removeFromCompactTableWithLength(table, key, keyLength);
+}
+
+void destroyCompactEngine (void *table) {
+    destroyCompactHashTable(table);
+}
+
+const struct BenchEngine benchEngines[] = {
+    {"chained", constructChainedEngine, addChainedEngine, searchChainedEngine, removeChainedEngine, destroyChainedEngine},
+    {"open", constructOpenEngine, addOpenEngine, searchOpenEngine, removeOpenEngine, destroyOpenEngine},
+    {"swiss", constructSwissEngine, addSwissEngine, searchSwissEngine, removeSwissEngine, destroySwissEngine},
+    {"compact", constructCompactEngine, addCompactEngine, searchCompactEngine, removeCompactEngine, destroyCompactEngine},
+};
+
+volatile long benchSink; // results are added here so lookups can't be optimized away
+
+/**
+ * Draws the next number from a generator
+ * @param random The generator
+ * @return A uniformly distributed 64-bit number
+ */
+uint64_t nextRandom (struct BenchRandom *random) {
+    random->state += 0x9e3779b97f4a7c15ull;
+    return mixHash(random->state);
+}
+
+/**
+ * Draws a number uniformly from [0, bound)
+ * @param random The generator
+ * @param bound The number of possible results
+ * @return The number
+ */
+long nextRandomBelow (struct BenchRandom *random, long bound) {
+    return (long) (nextRandom(random) % (uint64_t) bound); // the bias is negligible for bounds this far below 2^64
+}
+
+/**
+ * Sets up a Zipfian distribution, which takes a pass over every rank to sum the zeta function
+ * @param zipf The distribution to set up
+ * @param n The number of ranks
+ * @param theta The skew, between 0 and 1
+ */
+void initZipf (struct BenchZipf *zipf, long n, double theta) {
+    zipf->n = n;
+    zipf->theta = theta;
+    zipf->alpha = 1.0 / (1.0 - theta);
+    zipf->zetaN = 0;
+    zipf->eta = 0;
+    for (long i = 1; i <= n; i++) {
+        zipf->zetaN += 1.0 / pow((double) i, theta);
+    }
+    if (n < 3) return;
+    double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+    zipf->eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zipf->zetaN);
+}
+
+/**
+ * Draws a key index from a Zipfian distribution. The ranks are scattered over the keys by hashing, so the popular keys
+ * aren't simply the first ones added.
+ * @param zipf The distribution
+ * @param random The generator
+ * @return The index of a key, in [0, n)
+ */
+long nextZipf (struct BenchZipf *zipf, struct BenchRandom *random) {
+    if (zipf->n < 3) return nextRandomBelow(random, zipf->n); // too few ranks for the approximation
+    double u = (double) (nextRandom(random) >> 11) / (double) (1ull << 53);
+    double uz = u * zipf->zetaN;
+    long rank;
+    if (uz < 1.0) {
+        rank = 0;
+    } else if (uz < 1.0 + pow(0.5, zipf->theta)) {
+        rank = 1;
+    } else {
+        rank = (long) (zipf->n * pow(zipf->eta * u - zipf->eta + 1.0, zipf->alpha));
+        if (rank >= zipf->n) rank = zipf->n - 1;
+    }
+    return (long) (mixHash((uint64_t) rank) % (uint64_t) zipf->n);
+}
+
+/**
+ * Sets up an empty set of keys
+ * @param keys The set to set up
+ * @param capacity The most keys that will be added
+ */
+void initBenchKeys (struct BenchKeys *keys, long capacity) {
+    keys->keys = malloc(sizeof(char *) * capacity);
+    keys->lengths = malloc(sizeof(uint32_t) * capacity);
+    keys->count = 0;
+    initArena(&keys->storage, 1 << 20);
+}
+
+/**
+ * Copies a key into a set of keys
+ * @param keys The set to add to
+ * @param key The key, doesn't need to be null terminated
+ * @param length The length of the key in bytes
+ */
+void addBenchKey (struct BenchKeys *keys, const char *key, uint32_t length) {
+    keys->keys[keys->count] = arenaCopyString(&keys->storage, key, length);
+    keys->lengths[keys->count] = length;
+    keys->count++;
+}
+
+/**
+ * Frees a set of keys
+ * @param keys The set to free
+ */
+void releaseBenchKeys (struct BenchKeys *keys) {
+    releaseArena(&keys->storage);
+    free(keys->keys);
+    free(keys->lengths);
+}
+
+/**
+ * Makes a set of distinct keys that look like generated ids
+ * @param keys The set to fill, set up with room for count keys
+ * @param prefix The text every key starts with, present and missing keys use different prefixes
+ * @param count The number of keys
+ */
+void generateBenchKeys (struct BenchKeys *keys, const char *prefix, long count) {
+    char key[64];
+    for (long i = 0; i < count; i++) {
+        int length = snprintf(key, sizeof(key), "%s%ld", prefix, i);
+        addBenchKey(keys, key, (uint32_t) length);
+    }
+}
+
+/**
+ * Reads every distinct name of a names file into a set of keys, along with a set of keys that aren't in it
+ * @param path The path of the names file
+ * @param present The set to fill with the names
+ * @param missing The set to fill with keys that aren't names
+ * @return 0 if the file was read, -1 otherwise
+ */
+int loadBenchNames (const char *path, struct BenchKeys *present, struct BenchKeys *missing) {
+    struct MappedFile file;
+    if (mapFile(path, &file) != 0) return -1;
+    struct HashTableOptions options = defaultHashTableOptions();
+    struct HashTable *names = constructHashTableWithOptions(&options); // counting the names leaves one bucket per distinct name
+    loadKeysIntoTable(names, file.data, file.size);
+
+    initBenchKeys(present, names->numEntries > 0 ? names->numEntries : 1);
+    initBenchKeys(missing, names->numEntries > 0 ? names->numEntries : 1);
+    struct HashTableIterator iterator;
+    initHashTableIterator(names, &iterator);
+    char key[512];
+    for (struct Bucket *bucket = nextTableBucket(&iterator); bucket != 0; bucket = nextTableBucket(&iterator)) {
+        addBenchKey(present, bucketKey(bucket), bucket->keyLength);
+        uint32_t length = bucket->keyLength < sizeof(key) - 2 ? bucket->keyLength : sizeof(key) - 2;
+        memcpy(key, bucketKey(bucket), length);
+        memcpy(key + length, "#", 1); // no name has a # so the copy is always missing
+        addBenchKey(missing, key, length + 1);
+    }
+    destroyHashTable(names);
+    unmapFile(&file);
+    return present->count > 0 ? 0 : -1;
+}
+
+/**
+ * Gets the time from a monotonic clock
+ * @return The time in nanoseconds
+ */
+double nowNanoseconds () {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+/**
+ * Compares two latency samples for qsort
+ * @param a The first sample
+ * @param b The second sample
+ * @return Negative, zero or positive as a is less than, equal to or greater than b
+ */
+int compareSamples (const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Prints one result line, the throughput and the median and 99th percentile of the per-operation latency samples
+ * @param engine The engine that was run
+ * @param dataset The name of the keys used
+ * @param distribution The distribution keys were drawn from
+ * @param size The number of keys in the table
+ * @param workload The name of the workload
+ * @param operations The number of operations run
+ * @param total The nanoseconds taken by every operation together
+ * @param samples The nanoseconds per operation of each batch, sorted in place
+ * @param numSamples The number of samples
+ */
+void reportResult (const char *engine, const char *dataset, const char *distribution, long size, const char *workload, long operations, double total, double *samples, long numSamples) {
+    qsort(samples, numSamples, sizeof(double), compareSamples);
+    double p50 = numSamples > 0 ? samples[numSamples / 2] : 0;
+    double p99 = numSamples > 0 ? samples[(long) (numSamples * 0.99)] : 0;
+    double megaOps = total > 0 ? operations / total * 1e3 : 0; // operations per nanosecond times 1e3
+    printf("%s,%s,%s,%ld,%s,%ld,%.3f,%.1f,%.1f\n", engine, dataset, distribution, size, workload, operations, megaOps, p50, p99);
+    fflush(stdout);
+}
+
+/**
+ * Picks the index of the key an operation uses
+ * @param zipf The Zipfian distribution to draw from, 0 to draw uniformly
+ * @param random The generator
+ * @param count The number of keys
+ * @return The index of the key
+ */
+long pickKey (struct BenchZipf *zipf, struct BenchRandom *random, long count) {
+    return zipf != 0 ? nextZipf(zipf, random) : nextRandomBelow(random, count);
+}
+
+/**
+ * Runs every workload of one engine on one table size and prints a line for each
+ * @param engine The engine to run
+ * @param hashFunction The hash function the tables use
+ * @param dataset The name of the keys
+ * @param present The keys added to the table
+ * @param missing Keys that are never in the table
+ * @param size The number of keys to add, at most present->count
+ * @param zipf The Zipfian distribution over the first size keys
+ */
+void runWorkloads (const struct BenchEngine *engine, HashFunction hashFunction, const char *dataset, struct BenchKeys *present, struct BenchKeys *missing, long size, struct BenchZipf *zipf) {
+    long lookups = size > BENCH_MIN_OPERATIONS ? size : BENCH_MIN_OPERATIONS;
+    long maxSamples = (lookups > size ? lookups : size) / BENCH_LATENCY_BATCH + 1;
+    double *samples = malloc(sizeof(double) * maxSamples);
+    long numSamples;
+    struct BenchRandom random = {42};
+
+    double total;
+
+    void *table = engine->construct(hashFunction);
+    numSamples = 0;
+    total = 0;
+    for (long start = 0; start < size; start += BENCH_LATENCY_BATCH) { // insert, the table grows from empty
+        long end = size - start > BENCH_LATENCY_BATCH ? start + BENCH_LATENCY_BATCH : size; // the last batch may be partial
+        double before = nowNanoseconds();
+        for (long i = start; i < end; i++) {
+            engine->add(table, present->keys[i], present->lengths[i], (int) i);
+        }
+        double elapsed = nowNanoseconds() - before;
+        samples[numSamples++] = elapsed / (end - start);
+        total += elapsed;
+    }
+    reportResult(engine->name, dataset, "sequential", size, "insert", size, total, samples, numSamples);
+
+    for (int distribution = 0; distribution < 2; distribution++) {
+        struct BenchZipf *skew = distribution == 0 ? 0 : zipf;
+        const char *distributionName = distribution == 0 ? "uniform" : "zipfian";
+        long picks[BENCH_LATENCY_BATCH];
+        int operations[BENCH_LATENCY_BATCH];
+
+        numSamples = 0;
+        total = 0;
+        for (long done = 0; done + BENCH_LATENCY_BATCH <= lookups; done += BENCH_LATENCY_BATCH) { // lookups that hit
+            for (int i = 0; i < BENCH_LATENCY_BATCH; i++) {
+                picks[i] = pickKey(skew, &random, size); // drawn before timing so only the lookups are measured
+            }
+            long found = 0;
+            double before = nowNanoseconds();
+            for (int i = 0; i < BENCH_LATENCY_BATCH; i++) {
+                found += engine->search(table, present->keys[picks[i]], present->lengths[picks[i]]);
+            }
+            double elapsed = nowNanoseconds() - before;
+            samples[numSamples++] = elapsed / BENCH_LATENCY_BATCH;
+            total += elapsed;
+            benchSink += found;
+        }
+        reportResult(engine->name, dataset, distributionName, size, "hit", numSamples * BENCH_LATENCY_BATCH, total, samples, numSamples);
+
+        numSamples = 0;
+        total = 0;
+        long missingCount = missing->count < size ? missing->count : size;
+        for (long done = 0; done + BENCH_LATENCY_BATCH <= lookups; done += BENCH_LATENCY_BATCH) { // lookups that miss
+            for (int i = 0; i < BENCH_LATENCY_BATCH; i++) {
+                picks[i] = pickKey(skew, &random, missingCount) % missingCount;
+            }
+            long found = 0;
+            double before = nowNanoseconds();
+            for (int i = 0; i < BENCH_LATENCY_BATCH; i++) {
+                found += engine->search(table, missing->keys[picks[i]], missing->lengths[picks[i]]);
+            }
+            double elapsed = nowNanoseconds() - before;
+            samples[numSamples++] = elapsed / BENCH_LATENCY_BATCH;
+            total += elapsed;
+            benchSink += found;
+        }
+        reportResult(engine->name, dataset, distributionName, size, "miss", numSamples * BENCH_LATENCY_BATCH, total, samples, numSamples);
+
+        numSamples = 0;
+        total = 0;
+        long replaced = 0; // the number of missing keys added to keep the table the same size as present keys are removed
+        for (long done = 0; done + BENCH_LATENCY_BATCH <= lookups; done += BENCH_LATENCY_BATCH) { // 90% lookups, 5% adds, 5% removes
+            for (int i = 0; i < BENCH_LATENCY_BATCH; i++) {
+                picks[i] = pickKey(skew, &random, size);
+                operations[i] = (int) nextRandomBelow(&random, 20);
+            }
+            long found = 0;
+            double before = nowNanoseconds();
+            for (int i = 0; i < BENCH_LATENCY_BATCH; i++) {
+                long key = picks[i];
+                int operation = operations[i];
+                if (operation == 0 && replaced < missingCount) {
+                    engine->add(table, missing->keys[replaced], missing->lengths[replaced], (int) key);
+                    replaced++;
+                } else if (operation == 1) {
+                    engine->remove(table, present->keys[key], present->lengths[key]);
+                } else {
+                    found += engine->search(table, present->keys[key], present->lengths[key]);
+                }
+            }
+            double elapsed = nowNanoseconds() - before;
+            samples[numSamples++] = elapsed / BENCH_LATENCY_BATCH;
+            total += elapsed;
+            benchSink += found;
+        }
+        reportResult(engine->name, dataset, distributionName, size, "mixed", numSamples * BENCH_LATENCY_BATCH, total, samples, numSamples);
+
+        engine->destroy(table); // start the next distribution from a freshly built table, the mixed workload changed it
+        table = engine->construct(hashFunction);
+        for (long i = 0; i < size; i++) {
+            engine->add(table, present->keys[i], present->lengths[i], (int) i);
+        }
+    }
+
+    long *order = malloc(sizeof(long) * size);
+    for (long i = 0; i < size; i++) {
+        order[i] = i;
+    }
+    for (long i = size - 1; i > 0; i--) { // remove in a random order rather than the order the keys were added
+        long j = nextRandomBelow(&random, i + 1);
+        long swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+    numSamples = 0;
+    total = 0;
+    for (long start = 0; start < size; start += BENCH_LATENCY_BATCH) {
+        long end = size - start > BENCH_LATENCY_BATCH ? start + BENCH_LATENCY_BATCH : size;
+        double before = nowNanoseconds();
+        for (long i = start; i < end; i++) {
+            engine->remove(table, present->keys[order[i]], present->lengths[order[i]]);
+        }
+        double elapsed = nowNanoseconds() - before;
+        samples[numSamples++] = elapsed / (end - start);
+        total += elapsed;
+    }
+    reportResult(engine->name, dataset, "uniform", size, "remove", size, total, samples, numSamples);
+
+    free(order);
+    engine->destroy(table);
+    free(samples);
+}
+
+/**
+ * Prints how to run the benchmark
+ * @param program The name the benchmark was run as
+ */
+void printUsage (const char *program) {
+    fprintf(stderr, "usage: %s [--sizes 1000,100000,...] [--engines chained,open,swiss,compact] [--hash wyhash|djb2|siphash] [--names names.txt]\n", program);
+    fprintf(stderr, "sizes default to 1000,10000,100000,1000000 and can go up to 100000000 given the memory.\n");
+    fprintf(stderr, "results are printed as CSV, latencies are nanoseconds per operation over batches of %d.\n", BENCH_LATENCY_BATCH);
+}
+
+/**
+ * Checks whether an engine was asked for
+ * @param engines The comma separated list of engine names, 0 for every engine
+ * @param name The name of the engine
+ * @return 1 if the engine should run, 0 otherwise
+ */
+int engineWanted (const char *engines, const char *name) {
+    if (engines == 0) return 1;
+    size_t length = strlen(name);
+    for (const char *p = engines; (p = strstr(p, name)) != 0; p += length) {
+        if ((p == engines || p[-1] == ',') && (p[length] == ',' || p[length] == '\0')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Runs every engine over every table size with generated keys, then over the names file if there is one. Each
+ * workload prints a line of CSV: engine, dataset, distribution, size, workload, operations, million operations per
+ * second, median and 99th percentile nanoseconds per operation.
+ */
+int main (int argc, char *argv[]) {
+    long sizes[32] = {1000, 10000, 100000, 1000000};
+    int numSizes = 4;
+    const char *engines = 0;
+    const char *namesPath = "names.txt";
+    HashFunction hashFunction = wyHash;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            numSizes = 0;
+            for (char *size = strtok(argv[++i], ","); size != 0 && numSizes < 32; size = strtok(0, ",")) {
+                sizes[numSizes++] = atol(size);
+            }
+        } else if (strcmp(argv[i], "--engines") == 0 && i + 1 < argc) {
+            engines = argv[++i];
+        } else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "djb2") == 0) {
+                hashFunction = djb2Hash;
+            } else if (strcmp(argv[i], "siphash") == 0) {
+                hashFunction = sipHash;
+            } else {
+                hashFunction = wyHash;
+            }
+        } else if (strcmp(argv[i], "--names") == 0 && i + 1 < argc) {
+            namesPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    long largest = 0;
+    for (int i = 0; i < numSizes; i++) {
+        if (sizes[i] < 1 || sizes[i] > 100000000) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (sizes[i] > largest) largest = sizes[i];
+    }
+
+    printf("engine,dataset,distribution,size,workload,operations,mops,p50_ns,p99_ns\n");
+    struct BenchKeys present;
+    struct BenchKeys missing;
+    initBenchKeys(&present, largest);
+    initBenchKeys(&missing, largest);
+    generateBenchKeys(&present, "key:", largest);
+    generateBenchKeys(&missing, "miss:", largest);
+    for (int s = 0; s < numSizes; s++) {
+        struct BenchZipf zipf;
+        initZipf(&zipf, sizes[s], BENCH_ZIPF_THETA);
+        for (size_t e = 0; e < sizeof(benchEngines) / sizeof(benchEngines[0]); e++) {
+            if (engineWanted(engines, benchEngines[e].name)) {
+                runWorkloads(&benchEngines[e], hashFunction, "generated", &present, &missing, sizes[s], &zipf);
+            }
+        }
+    }
+    releaseBenchKeys(&present);
+    releaseBenchKeys(&missing);
+
+    if (loadBenchNames(namesPath, &present, &missing) == 0) {
+        struct BenchZipf zipf;
+        initZipf(&zipf, present.count, BENCH_ZIPF_THETA);
+        for (size_t e = 0; e < sizeof(benchEngines) / sizeof(benchEngines[0]); e++) {
+            if (engineWanted(engines, benchEngines[e].name)) {
+                runWorkloads(&benchEngines[e], hashFunction, "names", &present, &missing, present.count, &zipf);
+            }
+        }
+        releaseBenchKeys(&present);
+        releaseBenchKeys(&missing);
+    }
+    return 0;
+}
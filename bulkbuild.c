@@ -0,0 +1,229 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bulkbuild.h"
+
+
+#define MIN_KEYS_PER_THREAD 4096 // below this a thread costs more to start than it saves
+
+/**
+ * Works out which slice of the keys a worker is given
+ * @param build The build the worker is part of
+ * @param index The index of the worker
+ * @return The index of the first key of the slice, the slice ends where the next worker's starts
+ */
+int sliceStart (struct BulkBuild *build, int index) {
+    return (int) ((long) build->length * index / build->numThreads);
+}
+
+/**
+ * Works out which range of buckets a bucket falls in, each range is a contiguous run of buckets
+ * @param build The build the bucket is part of
+ * @param bucket The index of the bucket
+ * @return The index of the range, which is also the index of the worker that chains it
+ */
+int bucketRange (struct BulkBuild *build, int bucket) {
+    return (int) ((long) bucket * build->numThreads / build->table->numBuckets);
+}
+
+/**
+ * The first pass of a worker, hashes every key of its slice and counts how many fall in each bucket range
+ * @param argument The worker
+ * @return Nothing
+ */
+void* hashSlice (void *argument) {
+    struct BulkWorker *worker = argument;
+    struct BulkBuild *build = worker->build;
+    int *counts = &build->counts[worker->index * build->numThreads];
+    for (int i = sliceStart(build, worker->index); i < sliceStart(build, worker->index + 1); i++) {
+        struct KeyInfo *info = &build->keys[i];
+        if (build->names[i][0] == '\0') { // empty names are skipped, the same as readIntoTable
+            info->bucket = -1;
+            continue;
+        }
+        info->length = strlen(build->names[i]);
+        info->hash = build->table->hashFunction(build->names[i], info->length, build->table->seed);
+        info->bucket = bucketIndex(build->table, info->hash, build->table->numBuckets);
+        counts[bucketRange(build, info->bucket)]++;
+    }
+    return 0;
+}
+
+/**
+ * The second pass of a worker, writes the index of every key of its slice into the part of the order its range and
+ * slice were given. Every worker writes to its own part so no locks are needed.
+ * @param argument The worker
+ * @return Nothing
+ */
+void* scatterSlice (void *argument) {
+    struct BulkWorker *worker = argument;
+    struct BulkBuild *build = worker->build;
+    int *next = &build->counts[worker->index * build->numThreads]; // where the next key of each range goes
+    for (int i = sliceStart(build, worker->index); i < sliceStart(build, worker->index + 1); i++) {
+        if (build->keys[i].bucket >= 0) {
+            build->order[next[bucketRange(build, build->keys[i].bucket)]++] = i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * The last pass of a worker, chains every key of its bucket range. No other worker touches those buckets so they are
+ * updated without locks, and the keys are visited in the order they were given so the chains come out the same as
+ * adding them one at a time.
+ * @param argument The worker
+ * @return Nothing
+ */
+void* chainRange (void *argument) {
+    struct BulkWorker *worker = argument;
+    struct BulkBuild *build = worker->build;
+    for (int i = build->rangeStarts[worker->index]; i < build->rangeStarts[worker->index + 1]; i++) {
+        int key = build->order[i];
+        struct KeyInfo *info = &build->keys[key];
+        struct Bucket **bucket = &build->table->buckets[info->bucket];
+        struct Bucket *existing = searchBucket(*bucket, build->names[key], info->length, info->hash);
+        if (existing != 0) {
+            existing->value++;
+        } else {
+            *bucket = chainValue(&worker->bucketPool, *bucket, build->names[key], info->length, info->hash, 1);
+            worker->numEntries++;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Interns the key of every bucket a worker chained in a table's key pool, pointing the long keys at the pool's copy.
+ * The workers can't add to the one pool at once, so this is done by the calling thread once they have all finished,
+ * walking the worker's pool in the order its buckets were allocated.
+ * @param keyPool The pool of the table the keys are being read into
+ * @param bucketPool The worker's pool, none of whose buckets have been freed
+ */
+void internWorkerKeys (struct StringPool *keyPool, struct NodePool *bucketPool) {
+    for (struct ArenaBlock *block = bucketPool->arena.blocks; block != 0; block = block->next) {
+        for (size_t offset = 0; offset < block->used; offset += bucketPool->nodeSize) {
+            struct Bucket *bucket = (struct Bucket *) (block->data + offset);
+            uint32_t handle = internString(keyPool, bucketKey(bucket), bucket->keyLength);
+            if (handle != INVALID_STRING_HANDLE && bucket->keyLength >= INLINE_KEY_SIZE) {
+                bucket->key.pointer = poolString(keyPool, handle);
+            }
+        }
+    }
+}
+
+/**
+ * Runs a pass on every worker at once and waits for them all to finish. The calling thread runs the first worker
+ * itself, and any worker a thread can't be started for.
+ * @param workers The workers
+ * @param numThreads The number of workers
+ * @param pass The pass to run
+ */
+void runPass (struct BulkWorker *workers, int numThreads, void* (*pass) (void *)) {
+    pthread_t *threads = malloc(sizeof(pthread_t) * numThreads);
+    char *started = calloc(numThreads, 1);
+    for (int i = 1; i < numThreads; i++) {
+        started[i] = pthread_create(&threads[i], 0, pass, &workers[i]) == 0;
+    }
+    pass(&workers[0]);
+    for (int i = 1; i < numThreads; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], 0);
+        } else {
+            pass(&workers[i]);
+        }
+    }
+    free(started);
+    free(threads);
+}
+
+/**
+ * Function to read an array into the table using several threads, counting how many times each string appears, the
+ * same as readIntoTable. The bucket array is sized for every key up front, then the keys are hashed in parallel,
+ * grouped by range of buckets, and each thread builds the chains of its own range from its own pool. The buckets are
+ * only handed over to the table once every thread has finished. A table that already has keys in it, or is growing,
+ * is read into one key at a time instead.
+ * @param table The hashtable to add to
+ * @param names The array of strings to add
+ * @param length The length of the array
+ * @param numThreads The number of threads to use, 0 or less to use one per online processor
+ */
+void readIntoTableParallel (struct HashTable *table, char *names[], int length, int numThreads) {
+    if (table->numEntries != 0 || table->newBuckets != 0) {
+        readIntoTable(table, names, length);
+        return;
+    }
+    if (numThreads <= 0) {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = processors > 0 ? (int) processors : 1;
+    }
+    if (numThreads > length / MIN_KEYS_PER_THREAD) {
+        numThreads = length / MIN_KEYS_PER_THREAD;
+    }
+    if (numThreads <= 1) {
+        readIntoTable(table, names, length);
+        return;
+    }
+
+    if (table->maxLoadFactor > 0) { // size the buckets for every key being distinct so the table never grows mid-build
+        double wanted = length / table->maxLoadFactor;
+        int numBuckets = wanted < INT_MAX / 2 ? (int) wanted + 1 : INT_MAX / 2;
+        if (table->powerOfTwoBuckets) {
+            numBuckets = roundUpToPowerOfTwo(numBuckets);
+        }
+        if (numBuckets > table->numBuckets) {
+            free(table->buckets);
+            table->buckets = allocateBuckets(numBuckets);
+            table->numBuckets = numBuckets;
+        }
+    }
+
+    struct BulkBuild build;
+    build.table = table;
+    build.names = names;
+    build.length = length;
+    build.numThreads = numThreads;
+    build.keys = malloc(sizeof(struct KeyInfo) * length);
+    build.order = malloc(sizeof(int) * length);
+    build.counts = calloc((size_t) numThreads * numThreads, sizeof(int));
+    build.rangeStarts = malloc(sizeof(int) * (numThreads + 1));
+    struct BulkWorker *workers = malloc(sizeof(struct BulkWorker) * numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        workers[i].build = &build;
+        workers[i].index = i;
+        initNodePool(&workers[i].bucketPool, sizeof(struct Bucket), 1024);
+        workers[i].numEntries = 0;
+    }
+
+    runPass(workers, numThreads, hashSlice);
+    int position = 0;
+    for (int range = 0; range < numThreads; range++) { // turn the counts into where each worker's keys of each range start
+        build.rangeStarts[range] = position;
+        for (int worker = 0; worker < numThreads; worker++) {
+            int count = build.counts[worker * numThreads + range];
+            build.counts[worker * numThreads + range] = position;
+            position += count;
+        }
+    }
+    build.rangeStarts[numThreads] = position;
+    runPass(workers, numThreads, scatterSlice);
+    runPass(workers, numThreads, chainRange);
+
+    for (int i = 0; i < numThreads; i++) { // publish the buckets every worker chained
+        if (table->keyPool != 0) {
+            internWorkerKeys(table->keyPool, &workers[i].bucketPool);
+        }
+        mergeNodePool(&table->bucketPool, &workers[i].bucketPool);
+        table->numEntries += workers[i].numEntries;
+        COUNT_STAT(table, inserts, workers[i].numEntries);
+    }
+    growIfNeeded(table); // only needed when the buckets couldn't be sized for every key
+
+    free(workers);
+    free(build.rangeStarts);
+    free(build.counts);
+    free(build.order);
+    free(build.keys);
+}
@@ -0,0 +1,48 @@
+#ifndef BULKBUILD_H
+#define BULKBUILD_H
+
+#include <stdint.h>
+
+#include "arena.h"
+#include "hashtable.h"
+
+
+/**
+ * KeyInfo struct, what the first pass works out about each key so the later passes never hash it again
+ */
+struct KeyInfo {
+    uint64_t hash; // holds the hash of the key
+    uint32_t length; // holds the length of the key in bytes
+    int bucket; // holds the index of the top level bucket the key belongs in, -1 for a key that is skipped
+};
+
+/**
+ * BulkBuild struct, the state shared by every thread taking part in a parallel build. The buckets are split into one
+ * contiguous range per thread and each thread counts how many of its keys fall in every range, so the keys can be
+ * scattered into range order without any locks.
+ */
+struct BulkBuild {
+    struct HashTable *table; // holds the table being built
+    char **names; // holds the keys being added
+    int length; // holds the number of keys
+    int numThreads; // holds the number of threads, which is also the number of bucket ranges
+    struct KeyInfo *keys; // holds the hash and bucket of every key
+    int *order; // holds the index of every key, grouped by bucket range
+    int *counts; // holds numThreads counts per thread, the number of its keys in each range, then where they go in order
+    int *rangeStarts; // holds where each range starts in order, with one more entry for the end
+};
+
+/**
+ * BulkWorker struct, one thread of a parallel build. A worker hashes and scatters its own slice of the keys, then
+ * chains every key of its own bucket range from its own pool.
+ */
+struct BulkWorker {
+    struct BulkBuild *build; // holds the shared state
+    int index; // holds the index of the worker, its slice of the keys and its range of buckets
+    struct NodePool bucketPool; // holds the buckets this worker has chained
+    long numEntries; // holds the number of distinct keys this worker has added
+};
+
+void readIntoTableParallel (struct HashTable *table, char *names[], int length, int numThreads);
+
+#endif // BULKBUILD_H
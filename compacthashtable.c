@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "compacthashtable.h"
+
+#define COMPACT_MAX_BUCKETS ((uint32_t) 1 << 31) // the most buckets a table grows to, the largest power of two an index can count
+
+
+/**
+ * Sets the number of top level buckets of a table and empties them, the entries must be chained again afterwards
+ * @param table The table to set the buckets of
+ * @param numBuckets The number of buckets, a power of two of at least 2
+ * @return 0 if the buckets were allocated, -1 if there wasn't the memory, in which case the table is left as it was
+ */
+int allocateCompactBuckets (struct CompactHashTable *table, uint32_t numBuckets) {
+    uint32_t *buckets = malloc(sizeof(uint32_t) * (size_t) numBuckets);
+    if (buckets == 0) return -1;
+    memset(buckets, 0xff, sizeof(uint32_t) * (size_t) numBuckets); // every byte 0xff makes every bucket COMPACT_NONE
+    table->buckets = buckets;
+    table->numBuckets = numBuckets;
+    table->bucketShift = 64;
+    while (((uint64_t) 1 << (64 - table->bucketShift)) < numBuckets) {
+        table->bucketShift--;
+    }
+    return 0;
+}
+
+/**
+ * A function that creates a compact chained hashtable
+ * @param capacity The number of entries to make room for up front, the number of buckets starts the same
+ * @param maxLoadFactor The entries per bucket at which the buckets double, 0 for 2 so the buckets cost at most 4 bytes
+ *                      per entry
+ * @param hashFunction The function used to hash keys, 0 for wyHash
+ * @return The constructed CompactHashTable struct, 0 if there wasn't the memory
+ */
+struct CompactHashTable* constructCompactHashTable (int capacity, double maxLoadFactor, HashFunction hashFunction) {
+    struct CompactHashTable *table = malloc(sizeof(struct CompactHashTable));
+    if (table == 0) return 0;
+    capacity = capacity > 16 ? capacity : 16;
+    table->capacity = (uint32_t) capacity;
+    table->entries = malloc(sizeof(struct CompactEntry) * table->capacity);
+    if (table->entries == 0 || allocateCompactBuckets(table, (uint32_t) roundUpToPowerOfTwo(capacity)) != 0) {
+        free(table->entries);
+        free(table);
+        return 0;
+    }
+    table->numSlots = 0;
+    table->freeList = COMPACT_NONE;
+    table->numEntries = 0;
+    table->maxLoadFactor = maxLoadFactor > 0 ? maxLoadFactor : 2.0;
+    table->hashFunction = hashFunction != 0 ? hashFunction : wyHash;
+    table->seed = randomSeed();
+    initStringPool(&table->keys);
+    return table;
+}
+
+/**
+ * A function to delete and free the memory of a compact hashtable along with every key it copied
+ * @param table The table to delete
+ */
+void destroyCompactHashTable (struct CompactHashTable *table) {
+    releaseStringPool(&table->keys);
+    free(table->entries);
+    free(table->buckets);
+    free(table);
+}
+
+/**
+ * Gets the current load factor of the table, the average number of entries per top level bucket
+ * @param table The table to get the load factor of
+ * @return The load factor
+ */
+double getCompactLoadFactor (struct CompactHashTable *table) {
+    return (double) table->numEntries / table->numBuckets;
+}
+
+/**
+ * Gets how much memory a table holds, its buckets, its entry array and its key pool
+ * @param table The table to measure
+ * @return The number of bytes allocated
+ */
+size_t compactBytesAllocated (struct CompactHashTable *table) {
+    return sizeof(struct CompactHashTable) + sizeof(uint32_t) * (size_t) table->numBuckets
+        + sizeof(struct CompactEntry) * (size_t) table->capacity + table->keys.bytesAllocated;
+}
+
+/**
+ * Doubles the number of top level buckets and chains every entry again. No hash is kept, so every key is hashed again,
+ * read from the pool in the order the keys were added.
+ * @param table The table to grow, left as it was if there isn't the memory for the new buckets
+ */
+void growCompactTable (struct CompactHashTable *table) {
+    uint32_t *oldBuckets = table->buckets;
+    if (allocateCompactBuckets(table, table->numBuckets * 2) != 0) return; // the chains just get longer
+    free(oldBuckets);
+    for (uint32_t i = 0; i < table->numSlots; i++) {
+        struct CompactEntry *entry = &table->entries[i];
+        if (entry->key == INVALID_STRING_HANDLE) continue; // removed, it stays on the free list
+        uint64_t mixed = mixHash(table->hashFunction(poolString(&table->keys, entry->key), poolStringLength(&table->keys, entry->key), table->seed));
+        uint32_t bucket = (uint32_t) (mixed >> table->bucketShift);
+        entry->next = table->buckets[bucket];
+        table->buckets[bucket] = i;
+    }
+}
+
+/**
+ * Finds an unused entry, reusing the most recently removed one before growing the array
+ * @param table The table to find an entry in
+ * @return The index of the entry, COMPACT_NONE if every index is in use or the array couldn't grow
+ */
+uint32_t takeCompactEntry (struct CompactHashTable *table) {
+    if (table->freeList != COMPACT_NONE) {
+        uint32_t index = table->freeList;
+        table->freeList = table->entries[index].next;
+        return index;
+    }
+    if (table->numSlots == table->capacity) {
+        if (table->capacity == COMPACT_NONE) return COMPACT_NONE; // the last index is the end of a chain
+        uint64_t doubled = (uint64_t) table->capacity * 2;
+        uint32_t capacity = doubled < COMPACT_NONE ? (uint32_t) doubled : COMPACT_NONE;
+        struct CompactEntry *entries = realloc(table->entries, sizeof(struct CompactEntry) * (size_t) capacity); // entries are found by index, so they can move
+        if (entries == 0) return COMPACT_NONE; // the old array is still there and still in use
+        table->entries = entries;
+        table->capacity = capacity;
+    }
+    return table->numSlots++;
+}
+
+/**
+ * Adds the given key-pair value to the table, the key is copied into the table's pool so it doesn't need to stay in
+ * memory. The key doesn't need to be null terminated.
+ * @param table The table to add to
+ * @param key The key to add
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ * @return 0 if the key was added, -1 if it wasn't because every index or handle is in use or there wasn't the memory
+ */
+int addToCompactTableWithLength (struct CompactHashTable *table, char *key, uint32_t keyLength, int value) {
+    uint32_t index = takeCompactEntry(table);
+    if (index == COMPACT_NONE) return -1; // the table is full
+    uint32_t handle = appendString(&table->keys, key, keyLength);
+    if (handle == INVALID_STRING_HANDLE) { // the pool is full, give the entry back
+        table->entries[index].key = INVALID_STRING_HANDLE;
+        table->entries[index].next = table->freeList;
+        table->freeList = index;
+        return -1;
+    }
+
+    uint64_t mixed = mixHash(table->hashFunction(key, keyLength, table->seed));
+    uint32_t bucket = (uint32_t) (mixed >> table->bucketShift);
+    struct CompactEntry *entry = &table->entries[index];
+    entry->next = table->buckets[bucket]; // added to the front of the chain, the same as the chained HashTable
+    entry->key = handle;
+    entry->value = value;
+    table->buckets[bucket] = index;
+    table->numEntries++;
+
+    if (table->numEntries > table->maxLoadFactor * table->numBuckets && table->numBuckets < COMPACT_MAX_BUCKETS) {
+        growCompactTable(table);
+    }
+    return 0;
+}
+
+/**
+ * Adds the given key-pair value to the table, the key is copied into the table's pool
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ * @return 0 if the key was added, -1 if it wasn't
+ */
+int addToCompactTable (struct CompactHashTable *table, char *key, int value) {
+    return addToCompactTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Checks whether an entry holds the key given, comparing the lengths first so the key's bytes are only compared when
+ * they match. The length sits just before the key in the pool, so both are usually on the one cache line.
+ * @param table The table the entry is in
+ * @param entry The entry to check
+ * @param key The key to check for
+ * @param keyLength The length of the key in bytes
+ * @return 1 if the entry holds the key, 0 otherwise
+ */
+int compactEntryHasKey (struct CompactHashTable *table, struct CompactEntry *entry, char *key, uint32_t keyLength) {
+    return poolStringLength(&table->keys, entry->key) == keyLength && memcmp(poolString(&table->keys, entry->key), key, keyLength) == 0;
+}
+
+/**
+ * Searches the table for a key, the key doesn't need to be null terminated
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The entry the key is in, 0 if it can't be found. Adding to the table can move the entries, so it is only
+ *         valid until the next add.
+ */
+struct CompactEntry* searchCompactTableWithLength (struct CompactHashTable *table, char *key, uint32_t keyLength) {
+    uint64_t mixed = mixHash(table->hashFunction(key, keyLength, table->seed));
+    for (uint32_t index = table->buckets[mixed >> table->bucketShift]; index != COMPACT_NONE; index = table->entries[index].next) {
+        struct CompactEntry *entry = &table->entries[index];
+        if (compactEntryHasKey(table, entry, key, keyLength)) {
+            return entry;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Searches the table for a key
+ * @param table The table to search through
+ * @param key The key to search for
+ * @return The entry the key is in, 0 if it can't be found, valid until the next add
+ */
+struct CompactEntry* searchCompactTable (struct CompactHashTable *table, char *key) {
+    return searchCompactTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * Gets the key of an entry, from the table's pool
+ * @param table The table the entry is in
+ * @param entry The entry
+ * @return The key, null terminated and valid until the table is destroyed
+ */
+char* compactEntryKey (struct CompactHashTable *table, struct CompactEntry *entry) {
+    return poolString(&table->keys, entry->key);
+}
+
+/**
+ * A function to remove the key from the table, the key doesn't need to be null terminated. The entry goes on the
+ * free list to be reused by the next add, its key stays in the pool.
+ * @param table The table to remove the key from
+ * @param key The key to remove
+ * @param keyLength The length of the key in bytes
+ */
+void removeFromCompactTableWithLength (struct CompactHashTable *table, char *key, uint32_t keyLength) {
+    uint64_t mixed = mixHash(table->hashFunction(key, keyLength, table->seed));
+    uint32_t *link = &table->buckets[mixed >> table->bucketShift]; // holds the index that leads to the entry being looked at
+    while (*link != COMPACT_NONE) {
+        uint32_t index = *link;
+        struct CompactEntry *entry = &table->entries[index];
+        if (compactEntryHasKey(table, entry, key, keyLength)) {
+            *link = entry->next; // point past the entry being removed
+            entry->key = INVALID_STRING_HANDLE;
+            entry->next = table->freeList;
+            table->freeList = index;
+            table->numEntries--;
+            return;
+        }
+        link = &entry->next;
+    }
+}
+
+/**
+ * A function to remove the key from the table
+ * @param table The table to remove the key from
+ * @param key The key to remove
+ */
+void removeFromCompactTable (struct CompactHashTable *table, char *key) {
+    removeFromCompactTableWithLength(table, key, strlen(key));
+}
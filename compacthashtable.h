@@ -0,0 +1,60 @@
+#ifndef COMPACTHASHTABLE_H
+#define COMPACTHASHTABLE_H
+
+#include <stdint.h>
+
+#include "hash.h"
+#include "stringpool.h"
+
+#define COMPACT_NONE UINT32_MAX // the index that ends a chain or marks an empty bucket
+
+
+/**
+ * CompactEntry struct, a key-value pair in 12 bytes, linked to the next entry of its chain by index rather than by
+ * pointer
+ */
+struct CompactEntry {
+    uint32_t next; // holds the index of the next entry of the chain, COMPACT_NONE at the end of the chain
+    uint32_t key; // holds the handle of the key in the table's pool, INVALID_STRING_HANDLE once the entry is removed
+    int32_t value; // holds the value associated with the key
+};
+
+/**
+ * CompactHashTable struct, a chained hashtable for very large numbers of small entries. Every entry lives in one array
+ * and every key in one string pool, chains are linked with 32 bit indexes and the top level buckets are 32 bit
+ * indexes too, so nothing is allocated per entry. An entry costs its 12 bytes and, at the default load factor of 2,
+ * between 2 and 4 bytes of bucket, 14 to 16 bytes in all. Its key costs its own bytes in the pool and 5 to 8 more for
+ * the length before it, its terminator and alignment, so with 11 byte keys a table of a million or more keys measures
+ * 31 to 36 bytes per entry all told, depending on how much room is left in the entry array since it last doubled. No
+ * hash is kept with an entry, so each entry of a chain walked has its key's length read from the pool, and growing
+ * hashes the keys again, reading them from the pool in order. A load factor of 1 makes lookups faster for 2 more bytes
+ * of bucket per entry.
+ */
+struct CompactHashTable {
+    uint32_t numBuckets; // holds the number of top level buckets, a power of two
+    int bucketShift; // holds how far the mixed hash is shifted to get a bucket, 64 less the bits of numBuckets
+    uint32_t *buckets; // holds the index of the first entry of each bucket's chain, COMPACT_NONE for an empty bucket
+    struct CompactEntry *entries; // holds the array of entries, in the order they were added
+    uint32_t numSlots; // holds the number of entries used in the array, including ones that were removed
+    uint32_t capacity; // holds the number of entries there is room for in the array
+    uint32_t freeList; // holds the index of the most recently removed entry, each links to the one removed before it
+    long numEntries; // holds the number of key-value pairs stored in the table
+    double maxLoadFactor; // holds the entries per bucket at which the buckets double, 2 by default
+    HashFunction hashFunction; // holds the function used to hash keys
+    uint64_t seed; // holds the seed passed to the hash function, random for every table
+    struct StringPool keys; // holds every key added, a removed key's bytes stay until the table is destroyed
+};
+
+struct CompactHashTable* constructCompactHashTable (int capacity, double maxLoadFactor, HashFunction hashFunction);
+void destroyCompactHashTable (struct CompactHashTable *table);
+double getCompactLoadFactor (struct CompactHashTable *table);
+size_t compactBytesAllocated (struct CompactHashTable *table);
+int addToCompactTableWithLength (struct CompactHashTable *table, char *key, uint32_t keyLength, int value);
+int addToCompactTable (struct CompactHashTable *table, char *key, int value);
+struct CompactEntry* searchCompactTableWithLength (struct CompactHashTable *table, char *key, uint32_t keyLength);
+struct CompactEntry* searchCompactTable (struct CompactHashTable *table, char *key);
+char* compactEntryKey (struct CompactHashTable *table, struct CompactEntry *entry);
+void removeFromCompactTableWithLength (struct CompactHashTable *table, char *key, uint32_t keyLength);
+void removeFromCompactTable (struct CompactHashTable *table, char *key);
+
+#endif // COMPACTHASHTABLE_H
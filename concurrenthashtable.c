@@ -0,0 +1,543 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "concurrenthashtable.h"
+#include "epoch.h"
+
+
+/**
+ * A function to allocate an empty bucket array along with its migrated flags
+ * @param numBuckets The number of top level buckets required
+ * @param numStripes The number of stripes the table has
+ * @return The allocated array, 0 if it couldn't be allocated
+ */
+struct BucketArray* allocateBucketArray (int numBuckets, int numStripes) {
+    struct BucketArray *array = calloc(1, sizeof(struct BucketArray) + sizeof(struct Bucket *) * numBuckets + numStripes); // the flags go after the buckets
+    if (array == 0) return 0;
+    array->numBuckets = numBuckets;
+    array->successor = 0;
+    array->migrated = (char *) &array->buckets[numBuckets];
+    return array;
+}
+
+/**
+ * A function that creates a hashtable that can be shared between threads
+ * @param options The options to construct the table with, the number of buckets is rounded up to a power of two and
+ *                the rehash step is unused since each stripe is migrated in one go
+ * @param numStripes The number of lock stripes to split the buckets between, rounded up to a power of two
+ * @return The constructed ConcurrentHashTable struct, 0 if it couldn't be allocated or its stripes couldn't be allocated
+ *         on their own cache lines
+ */
+struct ConcurrentHashTable* constructConcurrentHashTable (const struct HashTableOptions *options, int numStripes) {
+    struct ConcurrentHashTable *table = malloc(sizeof(struct ConcurrentHashTable));
+    if (table == 0) return 0;
+    table->numStripes = roundUpToPowerOfTwo(numStripes);
+    table->numBuckets = roundUpToPowerOfTwo(options->numBuckets > table->numStripes ? options->numBuckets : table->numStripes); // every stripe needs at least one bucket
+    table->current = allocateBucketArray(table->numBuckets, table->numStripes);
+    if (table->current == 0) {
+        free(table);
+        return 0;
+    }
+    table->numEntries = 0;
+    table->maxLoadFactor = options->maxLoadFactor;
+    table->hashFunction = options->hashFunction != 0 ? options->hashFunction : wyHash;
+    table->seed = options->seed;
+    table->retiredArrays = 0;
+    table->version = 1;
+    table->numSnapshots = 0;
+    table->snapshots = 0;
+
+    if (posix_memalign((void **) &table->stripes, 64, sizeof(struct LockStripe) * table->numStripes) != 0) { // aligned so no two stripes share a cache line
+        free(table->current); // malloc's memory isn't aligned enough for a LockStripe
+        free(table);
+        return 0;
+    }
+    pthread_mutex_init(&table->resizeLock, 0);
+    for (int i = 0; i < table->numStripes; i++) {
+        struct LockStripe *stripe = &table->stripes[i];
+        pthread_mutex_init(&stripe->lock, 0);
+        initNodePool(&stripe->bucketPool, sizeof(struct ConcurrentBucket), 256);
+        stripe->retired = 0;
+        stripe->numRetired = 0;
+        stripe->retiredCapacity = 0;
+        stripe->reclaimThreshold = 64;
+    }
+    return table;
+}
+
+/**
+ * A function to free the arrays that have been replaced and that no reader can still be using
+ * @param table The table to free the replaced arrays of, its resizeLock must be held
+ * @param force Whether to free every replaced array, for when no thread is using the table any more
+ */
+void reclaimRetiredArrays (struct ConcurrentHashTable *table, int force) {
+    uint64_t oldest = oldestActiveEpoch();
+    struct RetiredArray **link = &table->retiredArrays;
+    while (*link != 0) {
+        struct RetiredArray *retired = *link;
+        if (force || retired->epoch < oldest) {
+            *link = retired->next;
+            free(retired->array);
+            free(retired);
+        } else {
+            link = &retired->next;
+        }
+    }
+}
+
+/**
+ * A function to delete and free the memory of a concurrent hashtable, no other thread may be using it and every
+ * snapshot of it must have been released
+ * @param table The table to delete
+ */
+void destroyConcurrentHashTable (struct ConcurrentHashTable *table) {
+    for (int i = 0; i < table->numStripes; i++) {
+        pthread_mutex_destroy(&table->stripes[i].lock);
+        releaseNodePool(&table->stripes[i].bucketPool); // every bucket in the stripe, retired or not, is freed a block at a time
+        free(table->stripes[i].retired);
+    }
+    reclaimRetiredArrays(table, 1);
+    pthread_mutex_destroy(&table->resizeLock);
+    free(table->stripes);
+    free(table->current);
+    free(table);
+}
+
+/**
+ * Gets the current load factor of the table, the average number of entries per top level bucket
+ * @param table The table to get the load factor of
+ * @return The load factor
+ */
+double getConcurrentLoadFactor (struct ConcurrentHashTable *table) {
+    return (double) __atomic_load_n(&table->numEntries, __ATOMIC_RELAXED) / __atomic_load_n(&table->numBuckets, __ATOMIC_RELAXED);
+}
+
+/**
+ * Finds the array holding a stripe's buckets, following the successors of any array the stripe has been migrated out
+ * of. Must be called inside an epoch, and writers must also hold the stripe's lock.
+ * @param table The table to look in
+ * @param stripeIndex The index of the stripe
+ * @return The array the stripe's buckets are in
+ */
+struct BucketArray* arrayForStripe (struct ConcurrentHashTable *table, int stripeIndex) {
+    struct BucketArray *array = __atomic_load_n(&table->current, __ATOMIC_ACQUIRE);
+    while (__atomic_load_n(&array->migrated[stripeIndex], __ATOMIC_ACQUIRE)) {
+        array = array->successor; // set before any stripe is marked as migrated
+    }
+    return array;
+}
+
+/**
+ * A function to free a stripe's retired buckets that no reader can still be using, the stripe's lock must be held
+ * @param stripe The stripe to free the retired buckets of
+ */
+void reclaimRetiredBuckets (struct LockStripe *stripe) {
+    uint64_t oldest = oldestActiveEpoch();
+    int kept = 0;
+    for (int i = 0; i < stripe->numRetired; i++) {
+        if (stripe->retired[i].epoch < oldest) {
+            poolFree(&stripe->bucketPool, stripe->retired[i].bucket);
+        } else {
+            stripe->retired[kept++] = stripe->retired[i]; // a reader may still be looking at this one
+        }
+    }
+    stripe->numRetired = kept;
+    stripe->reclaimThreshold = kept * 2 > 64 ? kept * 2 : 64; // don't keep rescanning buckets a long reader is holding on to
+}
+
+/**
+ * A function to hand an unlinked bucket over to be freed once no reader can still be using it, the stripe's lock
+ * must be held
+ * @param stripe The stripe the bucket belongs to
+ * @param bucket The unlinked bucket
+ * @param epoch The epoch returned by retireEpoch after the bucket was unlinked
+ */
+void retireBucket (struct LockStripe *stripe, struct Bucket *bucket, uint64_t epoch) {
+    if (stripe->numRetired == stripe->retiredCapacity) {
+        stripe->retiredCapacity = stripe->retiredCapacity > 0 ? stripe->retiredCapacity * 2 : 64;
+        stripe->retired = realloc(stripe->retired, sizeof(struct RetiredBucket) * stripe->retiredCapacity);
+    }
+    stripe->retired[stripe->numRetired].bucket = bucket;
+    stripe->retired[stripe->numRetired].epoch = epoch;
+    stripe->numRetired++;
+}
+
+/**
+ * Grows the table to the smallest power of two number of buckets that brings it back under its load factor, usually
+ * double the current number. Each stripe in turn is copied into the new array under its lock and then
+ * marked as migrated, so writers only ever wait for their own stripe and readers never wait at all. The buckets are
+ * copied rather than moved because a reader may still be walking the old chains. If another thread is already
+ * growing the table, or a snapshot is held, this returns straight away. Releasing the last snapshot grows the table if
+ * it went over its load factor meanwhile.
+ * @param table The table to grow
+ */
+void growConcurrentTable (struct ConcurrentHashTable *table) {
+    if (pthread_mutex_trylock(&table->resizeLock) != 0) return; // another thread is already growing the table
+    if (__atomic_load_n(&table->numSnapshots, __ATOMIC_RELAXED) > 0) { // only changed while holding resizeLock
+        pthread_mutex_unlock(&table->resizeLock); // a snapshot is reading the current array
+        return;
+    }
+
+    struct BucketArray *old = table->current; // only changed while holding resizeLock, so safe to read here
+    if (__atomic_load_n(&table->numEntries, __ATOMIC_RELAXED) <= table->maxLoadFactor * old->numBuckets || old->numBuckets > INT_MAX / 2) {
+        pthread_mutex_unlock(&table->resizeLock); // another thread grew the table first, or it can't grow any further
+        return;
+    }
+    reclaimRetiredArrays(table, 0); // free the arrays earlier growth left behind, if the readers are done with them
+
+    int numNewBuckets = old->numBuckets * 2;
+    while (numNewBuckets <= INT_MAX / 2 && __atomic_load_n(&table->numEntries, __ATOMIC_RELAXED) > table->maxLoadFactor * numNewBuckets) {
+        numNewBuckets *= 2; // adds made while a snapshot was held can leave the table several doublings behind
+    }
+    struct BucketArray *successor = allocateBucketArray(numNewBuckets, table->numStripes);
+    if (successor == 0) {
+        pthread_mutex_unlock(&table->resizeLock); // keep the current array, the next add tries again
+        return;
+    }
+    old->successor = successor; // published to readers by the release store of each migrated flag
+
+    for (int s = 0; s < table->numStripes; s++) {
+        struct LockStripe *stripe = &table->stripes[s];
+        pthread_mutex_lock(&stripe->lock);
+        for (int i = s; i < old->numBuckets; i += table->numStripes) { // every bucket in this stripe
+            for (struct Bucket *bucket = old->buckets[i]; bucket != 0; bucket = bucket->chainedBucket) {
+                if (((struct ConcurrentBucket *) bucket)->removeVersion != VERSION_LIVE) continue; // no snapshot is left that can see it
+                struct ConcurrentBucket *versioned = poolAllocate(&stripe->bucketPool);
+                *versioned = *(struct ConcurrentBucket *) bucket;
+                struct Bucket *copy = &versioned->bucket;
+                int boundedHash = mixHash(bucket->hash) & (uint64_t) (numNewBuckets - 1); // lands in the same stripe
+                copy->chainedBucket = successor->buckets[boundedHash];
+                successor->buckets[boundedHash] = copy; // no reader can see this stripe of the successor yet
+            }
+        }
+        __atomic_store_n(&old->migrated[s], 1, __ATOMIC_RELEASE); // from now on this stripe is read from the successor
+
+        uint64_t epoch = retireEpoch(); // the old chains are left intact for readers still walking them
+        for (int i = s; i < old->numBuckets; i += table->numStripes) {
+            for (struct Bucket *bucket = old->buckets[i]; bucket != 0; bucket = bucket->chainedBucket) {
+                retireBucket(stripe, bucket, epoch);
+            }
+        }
+        pthread_mutex_unlock(&stripe->lock);
+    }
+
+    __atomic_store_n(&table->current, successor, __ATOMIC_RELEASE);
+    __atomic_store_n(&table->numBuckets, numNewBuckets, __ATOMIC_RELAXED);
+    struct RetiredArray *retired = malloc(sizeof(struct RetiredArray));
+    retired->array = old;
+    retired->epoch = retireEpoch();
+    retired->next = table->retiredArrays;
+    table->retiredArrays = retired;
+
+    pthread_mutex_unlock(&table->resizeLock);
+}
+
+/**
+ * Adds the given key-pair value to the table, growing it if it goes over its maximum load factor. The new bucket is
+ * published with a single release store, so a reader sees either the old chain or the new one. The key doesn't need
+ * to be null terminated.
+ * @param table The table to add to
+ * @param key The key to add
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ */
+void addToConcurrentTableWithLength (struct ConcurrentHashTable *table, char *key, uint32_t keyLength, int value) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    uint64_t mixed = mixHash(keyHash);
+    int stripeIndex = mixed & (uint64_t) (table->numStripes - 1);
+    struct LockStripe *stripe = &table->stripes[stripeIndex];
+
+    enterEpoch(); // the stripe's lock doesn't stop an old array it is reached through being freed
+    pthread_mutex_lock(&stripe->lock);
+    struct BucketArray *array = arrayForStripe(table, stripeIndex);
+    struct Bucket **head = &array->buckets[mixed & (uint64_t) (array->numBuckets - 1)];
+    struct ConcurrentBucket *versioned = poolAllocate(&stripe->bucketPool);
+    versioned->addVersion = __atomic_load_n(&table->version, __ATOMIC_RELAXED); // only moved on while holding this lock
+    versioned->removeVersion = VERSION_LIVE;
+    struct Bucket *bucket = &versioned->bucket;
+    setBucketKey(bucket, key, keyLength);
+    bucket->hash = keyHash;
+    bucket->value = value;
+    bucket->chainedBucket = *head;
+    __atomic_store_n(head, bucket, __ATOMIC_RELEASE); // the bucket is fully set up before readers can reach it
+    if (stripe->numRetired >= stripe->reclaimThreshold) { // a good time to free what growing or removing left behind
+        reclaimRetiredBuckets(stripe);
+    }
+    pthread_mutex_unlock(&stripe->lock);
+    exitEpoch();
+
+    long numEntries = __atomic_add_fetch(&table->numEntries, 1, __ATOMIC_RELAXED);
+    if (table->maxLoadFactor > 0 && numEntries > table->maxLoadFactor * __atomic_load_n(&table->numBuckets, __ATOMIC_RELAXED)) {
+        growConcurrentTable(table);
+    }
+}
+
+/**
+ * Adds the given key-pair value to the table, growing it if it goes over its maximum load factor
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ */
+void addToConcurrentTable (struct ConcurrentHashTable *table, char *key, int value) {
+    addToConcurrentTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Searches the table for a key without taking any locks. The value is copied out before leaving the epoch, since the
+ * bucket it's in could be freed once a removed bucket's readers are done with it. The key doesn't need to be null
+ * terminated.
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @param value Set to the value stored for the key if it is found
+ * @return 1 if the key was found, 0 otherwise
+ */
+int searchConcurrentTableWithLength (struct ConcurrentHashTable *table, char *key, uint32_t keyLength, int *value) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    uint64_t mixed = mixHash(keyHash);
+    int found = 0;
+
+    enterEpoch();
+    struct BucketArray *array = arrayForStripe(table, mixed & (uint64_t) (table->numStripes - 1));
+    struct Bucket *bucket = __atomic_load_n(&array->buckets[mixed & (uint64_t) (array->numBuckets - 1)], __ATOMIC_ACQUIRE);
+    while (bucket != 0) {
+        if (bucketHasKey(bucket, key, keyLength, keyHash) && __atomic_load_n(&((struct ConcurrentBucket *) bucket)->removeVersion, __ATOMIC_RELAXED) == VERSION_LIVE) {
+            *value = bucket->value;
+            found = 1;
+            break;
+        }
+        bucket = __atomic_load_n(&bucket->chainedBucket, __ATOMIC_ACQUIRE);
+    }
+    exitEpoch();
+    return found;
+}
+
+/**
+ * Searches the table for a key without taking any locks
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param value Set to the value stored for the key if it is found
+ * @return 1 if the key was found, 0 otherwise
+ */
+int searchConcurrentTable (struct ConcurrentHashTable *table, char *key, int *value) {
+    return searchConcurrentTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * A function to remove the key from the table. The bucket is unlinked with a single release store and left intact,
+ * a reader already standing on it can still carry on down the chain, and it is only freed once every such reader has
+ * finished. While a snapshot is held the bucket is only stamped as removed instead, and stays in its chain so the
+ * snapshot can still see it. The key doesn't need to be null terminated.
+ * @param table The table to remove the key from.
+ * @param key The key to remove.
+ * @param keyLength The length of the key in bytes.
+ */
+void removeFromConcurrentTableWithLength (struct ConcurrentHashTable *table, char *key, uint32_t keyLength) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    uint64_t mixed = mixHash(keyHash);
+    int stripeIndex = mixed & (uint64_t) (table->numStripes - 1);
+    struct LockStripe *stripe = &table->stripes[stripeIndex];
+    int removed = 0;
+
+    enterEpoch(); // the stripe's lock doesn't stop an old array it is reached through being freed
+    pthread_mutex_lock(&stripe->lock);
+    struct BucketArray *array = arrayForStripe(table, stripeIndex);
+    struct Bucket **link = &array->buckets[mixed & (uint64_t) (array->numBuckets - 1)];
+    while (*link != 0) {
+        struct Bucket *current = *link;
+        struct ConcurrentBucket *versioned = (struct ConcurrentBucket *) current;
+        if (bucketHasKey(current, key, keyLength, keyHash) && versioned->removeVersion == VERSION_LIVE) {
+            if (__atomic_load_n(&table->numSnapshots, __ATOMIC_RELAXED) > 0) { // a stale count is safe, the release sweep unlinks the marked bucket under this stripe's lock
+                __atomic_store_n(&versioned->removeVersion, __atomic_load_n(&table->version, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+            } else {
+                __atomic_store_n(link, current->chainedBucket, __ATOMIC_RELEASE); // point past the bucket being removed
+                retireBucket(stripe, current, retireEpoch());
+            }
+            removed = 1;
+            break;
+        }
+        link = &current->chainedBucket;
+    }
+    if (stripe->numRetired >= stripe->reclaimThreshold) {
+        reclaimRetiredBuckets(stripe);
+    }
+    pthread_mutex_unlock(&stripe->lock);
+    exitEpoch();
+
+    if (removed) {
+        __atomic_sub_fetch(&table->numEntries, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * A function to remove the key from the table.
+ * @param table The table to remove the key from.
+ * @param key The key to remove.
+ */
+void removeFromConcurrentTable (struct ConcurrentHashTable *table, char *key) {
+    removeFromConcurrentTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * Takes a point-in-time snapshot of the table, seeing every bucket added before now and none added after, however
+ * long it is read for. Every stripe is locked at once while the table's version is moved on, so no write is part way
+ * through, and writers then carry on. Waits for the table to finish growing if it is.
+ * @param table The table to take a snapshot of
+ * @return The snapshot, which must be released with releaseConcurrentSnapshot
+ */
+struct ConcurrentSnapshot* snapshotConcurrentTable (struct ConcurrentHashTable *table) {
+    struct ConcurrentSnapshot *snapshot = malloc(sizeof(struct ConcurrentSnapshot));
+    snapshot->table = table;
+
+    pthread_mutex_lock(&table->resizeLock); // the table can't grow while the snapshot is being taken either
+    for (int s = 0; s < table->numStripes; s++) {
+        pthread_mutex_lock(&table->stripes[s].lock);
+    }
+    snapshot->version = table->version;
+    __atomic_store_n(&table->version, snapshot->version + 1, __ATOMIC_RELAXED); // writes from now on are after the snapshot
+    __atomic_store_n(&table->numSnapshots, table->numSnapshots + 1, __ATOMIC_RELAXED);
+    for (int s = 0; s < table->numStripes; s++) {
+        pthread_mutex_unlock(&table->stripes[s].lock);
+    }
+
+    snapshot->array = table->current;
+    snapshot->next = table->snapshots;
+    table->snapshots = snapshot;
+    pthread_mutex_unlock(&table->resizeLock);
+    return snapshot;
+}
+
+/**
+ * Checks whether a bucket was in the table when a snapshot was taken
+ * @param bucket The bucket
+ * @param version The version of the snapshot
+ * @return 1 if it was added before the snapshot and not removed until after, 0 otherwise
+ */
+int bucketInSnapshot (struct Bucket *bucket, uint64_t version) {
+    struct ConcurrentBucket *versioned = (struct ConcurrentBucket *) bucket;
+    return versioned->addVersion <= version && __atomic_load_n(&versioned->removeVersion, __ATOMIC_RELAXED) > version;
+}
+
+/**
+ * Releases a snapshot and unlinks the removed buckets that no snapshot still held can see. Releasing the last one
+ * unlinks every removed bucket, and grows the table if it went over its load factor while the snapshots were held.
+ * @param snapshot The snapshot to release, it can't be used afterwards
+ */
+void releaseConcurrentSnapshot (struct ConcurrentSnapshot *snapshot) {
+    struct ConcurrentHashTable *table = snapshot->table;
+    pthread_mutex_lock(&table->resizeLock);
+    struct ConcurrentSnapshot **link = &table->snapshots;
+    while (*link != snapshot) {
+        link = &(*link)->next;
+    }
+    *link = snapshot->next;
+    __atomic_sub_fetch(&table->numSnapshots, 1, __ATOMIC_RELAXED); // a write that hasn't seen this yet is seen below
+
+    uint64_t oldest = VERSION_LIVE; // a removed bucket is only needed by a snapshot taken after it was added and before it was removed
+    uint64_t newest = 0;
+    for (struct ConcurrentSnapshot *held = table->snapshots; held != 0; held = held->next) {
+        oldest = held->version < oldest ? held->version : oldest;
+        newest = held->version > newest ? held->version : newest;
+    }
+
+    struct BucketArray *array = table->current; // only changed while holding resizeLock
+    for (int s = 0; s < table->numStripes; s++) {
+        struct LockStripe *stripe = &table->stripes[s];
+        pthread_mutex_lock(&stripe->lock);
+        for (int i = s; i < array->numBuckets; i += table->numStripes) {
+            struct Bucket **bucket = &array->buckets[i];
+            while (*bucket != 0) {
+                struct Bucket *current = *bucket;
+                struct ConcurrentBucket *versioned = (struct ConcurrentBucket *) current;
+                if (versioned->removeVersion != VERSION_LIVE && (versioned->removeVersion <= oldest || versioned->addVersion > newest)) {
+                    __atomic_store_n(bucket, current->chainedBucket, __ATOMIC_RELEASE);
+                    retireBucket(stripe, current, retireEpoch());
+                } else {
+                    bucket = &current->chainedBucket;
+                }
+            }
+        }
+        if (stripe->numRetired >= stripe->reclaimThreshold) {
+            reclaimRetiredBuckets(stripe);
+        }
+        pthread_mutex_unlock(&stripe->lock);
+    }
+    pthread_mutex_unlock(&table->resizeLock);
+    free(snapshot);
+
+    if (table->maxLoadFactor > 0 && __atomic_load_n(&table->numEntries, __ATOMIC_RELAXED) > table->maxLoadFactor * __atomic_load_n(&table->numBuckets, __ATOMIC_RELAXED)) {
+        growConcurrentTable(table);
+    }
+}
+
+/**
+ * Calls a function on every bucket in a snapshot without taking any locks, while writers carry on with the table. The
+ * buckets are read SCAN_BUCKETS_PER_EPOCH top level buckets to an epoch, so a long scan doesn't keep the table's
+ * writers from freeing what they unlink. The visitor is called inside an epoch, so it must not use a concurrent table
+ * itself, and the bucket it is given is only valid until it returns.
+ * @param snapshot The snapshot to scan
+ * @param visitor The function called on each bucket
+ * @param context A pointer passed to each call of the visitor
+ * @return The number of buckets visited
+ */
+long scanConcurrentSnapshot (struct ConcurrentSnapshot *snapshot, BucketVisitor visitor, void *context) {
+    struct BucketArray *array = snapshot->array;
+    long numVisited = 0;
+    for (int start = 0; start < array->numBuckets; start += SCAN_BUCKETS_PER_EPOCH) {
+        int end = array->numBuckets - start > SCAN_BUCKETS_PER_EPOCH ? start + SCAN_BUCKETS_PER_EPOCH : array->numBuckets;
+        enterEpoch();
+        for (int i = start; i < end; i++) {
+            struct Bucket *bucket = __atomic_load_n(&array->buckets[i], __ATOMIC_ACQUIRE);
+            while (bucket != 0) {
+                if (bucketInSnapshot(bucket, snapshot->version)) {
+                    visitor(bucket, context);
+                    numVisited++;
+                }
+                bucket = __atomic_load_n(&bucket->chainedBucket, __ATOMIC_ACQUIRE);
+            }
+        }
+        exitEpoch();
+    }
+    return numVisited;
+}
+
+/**
+ * Searches a snapshot for a key without taking any locks, finding its value as it was when the snapshot was taken.
+ * The key doesn't need to be null terminated.
+ * @param snapshot The snapshot to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @param value Set to the value stored for the key if it is found
+ * @return 1 if the key was in the table when the snapshot was taken, 0 otherwise
+ */
+int searchConcurrentSnapshotWithLength (struct ConcurrentSnapshot *snapshot, char *key, uint32_t keyLength, int *value) {
+    struct ConcurrentHashTable *table = snapshot->table;
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    struct BucketArray *array = snapshot->array;
+    int found = 0;
+
+    enterEpoch();
+    struct Bucket *bucket = __atomic_load_n(&array->buckets[mixHash(keyHash) & (uint64_t) (array->numBuckets - 1)], __ATOMIC_ACQUIRE);
+    while (bucket != 0) {
+        if (bucketHasKey(bucket, key, keyLength, keyHash) && bucketInSnapshot(bucket, snapshot->version)) {
+            *value = bucket->value;
+            found = 1;
+            break;
+        }
+        bucket = __atomic_load_n(&bucket->chainedBucket, __ATOMIC_ACQUIRE);
+    }
+    exitEpoch();
+    return found;
+}
+
+/**
+ * Searches a snapshot for a key without taking any locks
+ * @param snapshot The snapshot to search through
+ * @param key The key to search for
+ * @param value Set to the value stored for the key if it is found
+ * @return 1 if the key was in the table when the snapshot was taken, 0 otherwise
+ */
+int searchConcurrentSnapshot (struct ConcurrentSnapshot *snapshot, char *key, int *value) {
+    return searchConcurrentSnapshotWithLength(snapshot, key, strlen(key), value);
+}
@@ -0,0 +1,121 @@
+#ifndef CONCURRENTHASHTABLE_H
+#define CONCURRENTHASHTABLE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "hash.h"
+#include "hashtable.h"
+
+#define VERSION_LIVE UINT64_MAX // the remove version of a bucket that hasn't been removed
+#define SCAN_BUCKETS_PER_EPOCH 256 // the top level buckets a snapshot scan reads before leaving its epoch and entering a new one
+
+
+/**
+ * BucketArray struct, one generation of a concurrent table's buckets. When the table grows each stripe is copied into
+ * the successor and then marked as migrated, so a reader still holding the old array is sent on to the new one.
+ */
+struct BucketArray {
+    int numBuckets; // holds the number of buckets in the array, a power of two
+    struct BucketArray *successor; // holds the array this one is being migrated into, 0 until the table grows
+    char *migrated; // holds a flag per stripe, set once that stripe has been copied into the successor
+    struct Bucket *buckets[]; // holds the top level buckets, 0 for an empty bucket
+};
+
+/**
+ * ConcurrentBucket struct, a bucket stamped with the versions of the table it was added and removed in, so a snapshot
+ * can tell which buckets were in the table when it was taken. The bucket comes first, so chains link these through
+ * their buckets' chainedBucket pointers.
+ */
+struct ConcurrentBucket {
+    struct Bucket bucket; // holds the key-value pair and the next bucket of the chain
+    uint64_t addVersion; // holds the version of the table the bucket was added in
+    uint64_t removeVersion; // holds the version it was removed in, VERSION_LIVE until then
+};
+
+/**
+ * RetiredBucket struct, a bucket that has been unlinked but may still be in use by a reader
+ */
+struct RetiredBucket {
+    struct Bucket *bucket; // holds the unlinked bucket
+    uint64_t epoch; // holds the epoch it was retired in, it can be freed once every reader has moved past it
+};
+
+/**
+ * LockStripe struct, serializes the writers of every bucket whose index is congruent to the stripe's index modulo the
+ * number of stripes. Readers never take it. Each stripe has its own pool so buckets can be allocated and freed under
+ * the stripe's lock alone.
+ */
+struct LockStripe {
+    pthread_mutex_t lock; // holds the lock writers take
+    struct NodePool bucketPool; // holds the pool the buckets of this stripe are allocated from
+    struct RetiredBucket *retired; // holds the buckets waiting for readers to finish with them
+    int numRetired; // holds the number of retired buckets
+    int retiredCapacity; // holds the number of retired buckets there is room for
+    int reclaimThreshold; // holds the number of retired buckets at which they are next reclaimed
+} __attribute__((aligned(64))); // keep each stripe on its own cache lines so stripes don't contend
+
+/**
+ * RetiredArray struct, a bucket array that has been replaced but may still be in use by a reader
+ */
+struct RetiredArray {
+    struct BucketArray *array; // holds the replaced array
+    uint64_t epoch; // holds the epoch it was retired in
+    struct RetiredArray *next; // holds the array retired before this one
+};
+
+/**
+ * ConcurrentHashTable struct, a chained hashtable that can be used from many threads at once. Lookups take no locks
+ * and write nothing but their own epoch slot: writers publish every change with a single atomic pointer store, and
+ * buckets they unlink are only freed once no reader can still be looking at them. Writers are split between lock stripes so threads
+ * writing to different stripes never wait on each other. The number of buckets is always a power of two and a multiple
+ * of the number of stripes, so a key stays in the same stripe when the table doubles in size.
+ */
+struct ConcurrentHashTable {
+    struct BucketArray *current; // holds the array new lookups start from
+    int numBuckets; // holds the number of buckets in the current array
+    int numStripes; // holds the number of lock stripes, a power of two
+    struct LockStripe *stripes; // holds the array of lock stripes
+    long numEntries; // holds the number of key-value pairs stored in the table, updated atomically
+    double maxLoadFactor; // holds the load factor at which the table starts growing, 0 to never grow
+    HashFunction hashFunction; // holds the function used to hash keys
+    uint64_t seed; // holds the seed passed to the hash function
+    pthread_mutex_t resizeLock; // holds the lock that stops two threads growing the table at once
+    struct RetiredArray *retiredArrays; // holds the replaced arrays waiting for readers to finish, under resizeLock
+    uint64_t version; // holds the version writes are stamped with, moved on by every snapshot while holding every stripe
+    int numSnapshots; // holds the number of snapshots not yet released, while there are any removed buckets stay linked
+    struct ConcurrentSnapshot *snapshots; // holds the snapshots not yet released, under resizeLock
+};
+
+/**
+ * ConcurrentSnapshot struct, a point-in-time view of a concurrent table that can be read while writers carry on. It
+ * sees every bucket added before it was taken and not removed until after, by comparing the buckets' versions with its
+ * own. While any snapshot is held removed buckets are only marked as removed and the table doesn't grow, so the array
+ * it reads from stays the table's current one and every bucket it needs stays in its chain.
+ */
+struct ConcurrentSnapshot {
+    struct ConcurrentHashTable *table; // holds the table the snapshot was taken of
+    struct BucketArray *array; // holds the table's array when the snapshot was taken, which stays current until it is released
+    uint64_t version; // holds the table's version when the snapshot was taken, later writes are stamped with greater ones
+    struct ConcurrentSnapshot *next; // holds the snapshot taken before this one, under the table's resizeLock
+};
+
+typedef void (*BucketVisitor)(struct Bucket *bucket, void *context);
+
+struct ConcurrentHashTable* constructConcurrentHashTable (const struct HashTableOptions *options, int numStripes);
+void destroyConcurrentHashTable (struct ConcurrentHashTable *table);
+double getConcurrentLoadFactor (struct ConcurrentHashTable *table);
+void addToConcurrentTableWithLength (struct ConcurrentHashTable *table, char *key, uint32_t keyLength, int value);
+void addToConcurrentTable (struct ConcurrentHashTable *table, char *key, int value);
+int searchConcurrentTableWithLength (struct ConcurrentHashTable *table, char *key, uint32_t keyLength, int *value);
+int searchConcurrentTable (struct ConcurrentHashTable *table, char *key, int *value);
+void removeFromConcurrentTableWithLength (struct ConcurrentHashTable *table, char *key, uint32_t keyLength);
+void removeFromConcurrentTable (struct ConcurrentHashTable *table, char *key);
+struct ConcurrentSnapshot* snapshotConcurrentTable (struct ConcurrentHashTable *table);
+void releaseConcurrentSnapshot (struct ConcurrentSnapshot *snapshot);
+long scanConcurrentSnapshot (struct ConcurrentSnapshot *snapshot, BucketVisitor visitor, void *context);
+int searchConcurrentSnapshotWithLength (struct ConcurrentSnapshot *snapshot, char *key, uint32_t keyLength, int *value);
+int searchConcurrentSnapshot (struct ConcurrentSnapshot *snapshot, char *key, int *value);
+
+#endif // CONCURRENTHASHTABLE_H
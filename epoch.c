@@ -0,0 +1,105 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "epoch.h"
+
+
+/**
+ * EpochSlot struct, holds the epoch a reader thread entered in, each on its own cache line
+ */
+struct EpochSlot {
+    uint64_t epoch; // holds the epoch the thread entered in, 0 when it isn't reading
+    int inUse; // holds whether a thread has claimed this slot
+} __attribute__((aligned(64)));
+
+static struct EpochSlot epochSlots[MAX_EPOCH_THREADS];
+static int numEpochSlots = 0; // holds one more than the highest slot ever claimed, so scans can stop there
+static uint64_t globalEpoch = 1; // 0 is kept to mean not reading
+static pthread_key_t epochSlotKey;
+static pthread_once_t epochSlotKeyOnce = PTHREAD_ONCE_INIT;
+static __thread int threadEpochSlot = -1; // holds the slot this thread claimed, -1 until it first reads
+
+/**
+ * Gives a thread's slot back when the thread exits
+ * @param slot One more than the index of the slot to give back
+ */
+static void releaseEpochSlot (void *slot) {
+    int index = (int) (intptr_t) slot - 1;
+    __atomic_store_n(&epochSlots[index].epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&epochSlots[index].inUse, 0, __ATOMIC_RELEASE);
+}
+
+static void createEpochSlotKey () {
+    pthread_key_create(&epochSlotKey, releaseEpochSlot);
+}
+
+/**
+ * Claims a free slot for the calling thread, the slot is given back automatically when the thread exits
+ * @return The index of the slot claimed
+ */
+static int claimEpochSlot () {
+    pthread_once(&epochSlotKeyOnce, createEpochSlotKey);
+    for (int i = 0; i < MAX_EPOCH_THREADS; i++) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&epochSlots[i].inUse, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            int used = __atomic_load_n(&numEpochSlots, __ATOMIC_SEQ_CST);
+            while (used < i + 1 && !__atomic_compare_exchange_n(&numEpochSlots, &used, i + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            } // sequentially consistent so a scan that follows a retire can't miss this slot
+            pthread_setspecific(epochSlotKey, (void *) (intptr_t) (i + 1));
+            return i;
+        }
+    }
+    fprintf(stderr, "more than %d threads reading concurrent hashtables at once\n", MAX_EPOCH_THREADS);
+    abort();
+}
+
+/**
+ * Announces that the calling thread is about to read shared memory. The announcement is checked against the global
+ * epoch again afterwards, so a writer that retired memory in between is sure to either see it or have unlinked the
+ * memory before this thread could reach it.
+ */
+void enterEpoch () {
+    if (threadEpochSlot < 0) {
+        threadEpochSlot = claimEpochSlot();
+    }
+    struct EpochSlot *slot = &epochSlots[threadEpochSlot];
+    uint64_t epoch = __atomic_load_n(&globalEpoch, __ATOMIC_SEQ_CST);
+    for (;;) {
+        __atomic_store_n(&slot->epoch, epoch, __ATOMIC_SEQ_CST);
+        uint64_t current = __atomic_load_n(&globalEpoch, __ATOMIC_SEQ_CST);
+        if (current == epoch) break;
+        epoch = current; // a writer retired something meanwhile, announce the newer epoch instead
+    }
+}
+
+/**
+ * Announces that the calling thread has finished reading shared memory and holds no pointers into it
+ */
+void exitEpoch () {
+    __atomic_store_n(&epochSlots[threadEpochSlot].epoch, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Stamps memory that a writer has just unlinked, it must have been unlinked before this is called
+ * @return The stamp, the memory can be freed once oldestActiveEpoch is greater than it
+ */
+uint64_t retireEpoch () {
+    return __atomic_fetch_add(&globalEpoch, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Finds the epoch of the longest running reader
+ * @return The oldest epoch announced by a reader, or the current epoch if nothing is being read
+ */
+uint64_t oldestActiveEpoch () {
+    uint64_t oldest = __atomic_load_n(&globalEpoch, __ATOMIC_SEQ_CST);
+    int used = __atomic_load_n(&numEpochSlots, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < used; i++) {
+        uint64_t epoch = __atomic_load_n(&epochSlots[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
@@ -0,0 +1,21 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdint.h>
+
+
+/**
+ * Epoch based reclamation, shared by every concurrent table in the process. A reader announces the epoch it started
+ * in before touching shared memory and clears it when done, writing only to a slot on its own cache line. Memory
+ * unlinked by a writer is stamped with retireEpoch and may be freed once oldestActiveEpoch is past the stamp, since
+ * every reader that could still reach it has finished by then.
+ */
+
+#define MAX_EPOCH_THREADS 1024 // the most threads that can be reading at once
+
+void enterEpoch ();
+void exitEpoch ();
+uint64_t retireEpoch ();
+uint64_t oldestActiveEpoch ();
+
+#endif // EPOCH_H
@@ -0,0 +1,172 @@
+#ifndef FIXEDHASHTABLE_H
+#define FIXEDHASHTABLE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "generichashtable.h"
+#include "hash.h"
+
+
+/**
+ * Hashes a key of a fixed capacity table with wyHash
+ * @param key The key to hash, not necessarily null terminated
+ * @param keyLength The length of the key in bytes
+ * @return The hash of the key
+ */
+static inline uint64_t hashFixedKey (const char *key, uint32_t keyLength) {
+    return wyHash(key, keyLength, 0);
+}
+
+/**
+ * Defines a hashtable of string keys with a capacity and a longest key fixed at compile time, for small maps on a hot
+ * path. The whole table is one struct holding an array of entries, keys copied into the entries themselves, so it can
+ * live on the stack or inside another struct and never touches the heap. The number of slots is a power of two known
+ * at compile time, so finding a key's slot is a mask of a constant. Collisions are resolved with Robin Hood linear
+ * probing and backward shift deletion like DEFINE_HASHTABLE, and the table never grows: once it holds 7/8 of its slots
+ * nothing more is added, so probes stay short and there is always an empty slot to stop at.
+ *
+ * DEFINE_FIXED_HASHTABLE(HeaderMap, 64, 31, int, hashFixedKey) defines struct HeaderMap and struct HeaderMapEntry
+ * along with:
+ *   void initHeaderMap (struct HeaderMap *table), which also empties a table that was used before
+ *   int* searchHeaderMapWithLength (struct HeaderMap *table, const char *key, uint32_t keyLength)
+ *   int* searchHeaderMap (struct HeaderMap *table, const char *key), 0 if the key isn't in the table
+ *   int* getOrInsertHeaderMapWithLength (struct HeaderMap *table, const char *key, uint32_t keyLength, int defaultValue)
+ *   int* getOrInsertHeaderMap (struct HeaderMap *table, const char *key, int defaultValue), 0 if the table is full or
+ *       the key is too long
+ *   int upsertHeaderMap (struct HeaderMap *table, const char *key, int value), 1 if the value was stored
+ *   int removeFromHeaderMapWithLength (struct HeaderMap *table, const char *key, uint32_t keyLength)
+ *   int removeFromHeaderMap (struct HeaderMap *table, const char *key), 1 if the key was removed
+ * Value pointers stay valid until the table is next added to or removed from. The entries can be walked directly,
+ * every slot with a tag other than 0 holds one.
+ *
+ * @param Name The name of the table struct, also used in the name of every function
+ * @param NumSlots The number of slots in the table, a power of two of at least 8. At most 7/8 of them are filled.
+ * @param MaxKeyLength The longest key in bytes the table can hold, less than 65536
+ * @param ValueType The type of the values, copied by assignment
+ * @param hashKey A function or macro taking a key and its length and returning a uint64_t hash that spreads its bits
+ */
+#define DEFINE_FIXED_HASHTABLE(Name, NumSlots, MaxKeyLength, ValueType, hashKey) \
+\
+typedef char Name##SlotsArePowerOfTwo[(NumSlots) >= 8 && ((NumSlots) & ((NumSlots) - 1)) == 0 ? 1 : -1]; /* fails to compile otherwise, fewer than 8 would leave no slot empty */ \
+typedef char Name##KeyLengthFits[(MaxKeyLength) > 0 && (MaxKeyLength) < 65536 ? 1 : -1]; \
+\
+struct Name##Entry { \
+    uint32_t tag; /* holds the low bits of the key's hash with the top bit set, 0 when the slot is empty */ \
+    uint16_t keyLength; /* holds the length of the key in bytes */ \
+    ValueType value; /* holds the value associated with the key */ \
+    char key[(MaxKeyLength) + 1]; /* holds a copy of the key, null terminated */ \
+}; \
+\
+struct Name { \
+    int numEntries; /* holds the number of key-value pairs stored in the table */ \
+    struct Name##Entry entries[NumSlots]; /* holds every slot of the table */ \
+}; \
+\
+static inline void init##Name (struct Name *table) { \
+    table->numEntries = 0; \
+    for (int i = 0; i < (NumSlots); i++) { \
+        table->entries[i].tag = 0; /* only the tags need clearing, the rest of an empty slot is never read */ \
+    } \
+} \
+\
+static inline int probeDistance##Name (uint32_t tag, int index) { \
+    return (index - (int) (tag & (uint32_t) ((NumSlots) - 1))) & ((NumSlots) - 1); \
+} \
+\
+/* finds the slot holding a key, -1 if it can't be found */ \
+static inline int findIndex##Name (struct Name *table, const char *key, uint32_t keyLength, uint32_t tag) { \
+    int index = (int) (tag & (uint32_t) ((NumSlots) - 1)); \
+    int distance = 0; \
+    while (table->entries[index].tag != 0 && distance <= probeDistance##Name(table->entries[index].tag, index)) { \
+        struct Name##Entry *entry = &table->entries[index]; \
+        if (entry->tag == tag && entry->keyLength == keyLength && memcmp(entry->key, key, keyLength) == 0) { /* only compare the keys when the tags match */ \
+            return index; \
+        } \
+        index = (index + 1) & ((NumSlots) - 1); \
+        distance++; \
+    } \
+    return -1; \
+} \
+\
+static inline ValueType* search##Name##WithLength (struct Name *table, const char *key, uint32_t keyLength) { \
+    if (keyLength > (MaxKeyLength)) return 0; /* too long to have been added */ \
+    int index = findIndex##Name(table, key, keyLength, genericHashTag(hashKey(key, keyLength))); \
+    return index >= 0 ? &table->entries[index].value : 0; \
+} \
+\
+static inline ValueType* search##Name (struct Name *table, const char *key) { \
+    return search##Name##WithLength(table, key, strlen(key)); \
+} \
+\
+/* places a new key the Robin Hood way, moving the entries it displaces on, and returns the slot it ended up in */ \
+static inline int placeKey##Name (struct Name *table, const char *key, uint32_t keyLength, uint32_t tag, ValueType value) { \
+    int index = (int) (tag & (uint32_t) ((NumSlots) - 1)); \
+    int distance = 0; \
+    while (table->entries[index].tag != 0 && probeDistance##Name(table->entries[index].tag, index) >= distance) { \
+        index = (index + 1) & ((NumSlots) - 1); \
+        distance++; \
+    } \
+    int placed = index; /* the first entry closer to home than the new key gives up its slot */ \
+    struct Name##Entry displaced = table->entries[index]; \
+    table->entries[index].tag = tag; \
+    table->entries[index].keyLength = (uint16_t) keyLength; \
+    table->entries[index].value = value; \
+    memcpy(table->entries[index].key, key, keyLength); \
+    table->entries[index].key[keyLength] = '\0'; \
+    while (displaced.tag != 0) { \
+        index = (index + 1) & ((NumSlots) - 1); \
+        distance = probeDistance##Name(displaced.tag, index); \
+        if (table->entries[index].tag == 0 || probeDistance##Name(table->entries[index].tag, index) < distance) { \
+            struct Name##Entry next = table->entries[index]; \
+            table->entries[index] = displaced; \
+            displaced = next; \
+        } \
+    } \
+    return placed; \
+} \
+\
+static inline ValueType* getOrInsert##Name##WithLength (struct Name *table, const char *key, uint32_t keyLength, ValueType defaultValue) { \
+    if (keyLength > (MaxKeyLength)) return 0; /* there is no room to copy it */ \
+    uint32_t tag = genericHashTag(hashKey(key, keyLength)); \
+    int index = findIndex##Name(table, key, keyLength, tag); \
+    if (index >= 0) { \
+        return &table->entries[index].value; \
+    } \
+    if (table->numEntries >= (NumSlots) - (NumSlots) / 8) return 0; /* the table is full */ \
+    table->numEntries++; \
+    return &table->entries[placeKey##Name(table, key, keyLength, tag, defaultValue)].value; \
+} \
+\
+static inline ValueType* getOrInsert##Name (struct Name *table, const char *key, ValueType defaultValue) { \
+    return getOrInsert##Name##WithLength(table, key, strlen(key), defaultValue); \
+} \
+\
+static inline int upsert##Name (struct Name *table, const char *key, ValueType value) { \
+    ValueType *stored = getOrInsert##Name(table, key, value); \
+    if (stored == 0) return 0; \
+    *stored = value; \
+    return 1; \
+} \
+\
+/* removes a key, shifting the entries after it back a slot so no tombstones are needed */ \
+static inline int removeFrom##Name##WithLength (struct Name *table, const char *key, uint32_t keyLength) { \
+    if (keyLength > (MaxKeyLength)) return 0; \
+    int index = findIndex##Name(table, key, keyLength, genericHashTag(hashKey(key, keyLength))); \
+    if (index < 0) return 0; /* nothing to remove */ \
+    int next = (index + 1) & ((NumSlots) - 1); \
+    while (table->entries[next].tag != 0 && probeDistance##Name(table->entries[next].tag, next) > 0) { \
+        table->entries[index] = table->entries[next]; /* shift the entry back a slot, closer to its home */ \
+        index = next; \
+        next = (next + 1) & ((NumSlots) - 1); \
+    } \
+    table->entries[index].tag = 0; /* the last shifted slot becomes empty */ \
+    table->numEntries--; \
+    return 1; \
+} \
+\
+static inline int removeFrom##Name (struct Name *table, const char *key) { \
+    return removeFrom##Name##WithLength(table, key, strlen(key)); \
+}
+
+#endif // FIXEDHASHTABLE_H
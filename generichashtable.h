@@ -0,0 +1,209 @@
+#ifndef GENERICHASHTABLE_H
+#define GENERICHASHTABLE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash.h"
+
+
+/**
+ * Hashes an integer key with the splitmix64 finalizer, cheap enough that integer keys never need formatting as strings
+ * @param key The key to hash
+ * @return The hash of the key
+ */
+static inline uint64_t hashInteger (uint64_t key) {
+    return mixHash(key + 0x9e3779b97f4a7c15ull); // offset first so a key of 0 doesn't hash to 0
+}
+
+/**
+ * Checks whether two integer keys are equal
+ * @param a The first key
+ * @param b The second key
+ * @return 1 if the keys are equal, 0 otherwise
+ */
+static inline int integersEqual (uint64_t a, uint64_t b) {
+    return a == b;
+}
+
+/**
+ * Hashes a null terminated string key with wyHash
+ * @param key The key to hash
+ * @return The hash of the key
+ */
+static inline uint64_t hashString (const char *key) {
+    return wyHash(key, strlen(key), 0);
+}
+
+/**
+ * Checks whether two null terminated string keys are equal
+ * @param a The first key
+ * @param b The second key
+ * @return 1 if the keys are equal, 0 otherwise
+ */
+static inline int stringsEqual (const char *a, const char *b) {
+    return a == b || strcmp(a, b) == 0;
+}
+
+/**
+ * Works out the tag stored with an entry from the hash of its key. The top bit is always set so a tag of 0 can mark an
+ * empty slot, whatever the type of the keys.
+ * @param hash The hash of the key
+ * @return The tag, never 0
+ */
+static inline uint32_t genericHashTag (uint64_t hash) {
+    return (uint32_t) hash | 0x80000000u;
+}
+
+/**
+ * Defines a hashtable for one key and value type, in the style of klib's khash. The table stores every entry in one
+ * flat array, keys and values in place rather than behind pointers, and resolves collisions with Robin Hood linear
+ * probing and backward shift deletion like OpenHashTable. Only 32 bits of each hash are kept with the entry, enough to
+ * find its home slot again when growing and to skip most key comparisons, so an entry with 64-bit keys and int values
+ * takes 16 bytes.
+ *
+ * DEFINE_HASHTABLE(IntMap, uint64_t, int, hashInteger, integersEqual) defines struct IntMap and struct IntMapEntry
+ * along with:
+ *   struct IntMap* constructIntMap (int capacity, double maxLoadFactor)
+ *   void destroyIntMap (struct IntMap *table)
+ *   double getIntMapLoadFactor (struct IntMap *table)
+ *   int* searchIntMap (struct IntMap *table, uint64_t key), 0 if the key isn't in the table
+ *   int* getOrInsertIntMap (struct IntMap *table, uint64_t key, int defaultValue)
+ *   void upsertIntMap (struct IntMap *table, uint64_t key, int value)
+ *   int removeFromIntMap (struct IntMap *table, uint64_t key), 1 if the key was removed
+ * Value pointers stay valid until the table is next added to or removed from.
+ *
+ * @param Name The name of the table struct, also used in the name of every function
+ * @param KeyType The type of the keys, copied by assignment
+ * @param ValueType The type of the values, copied by assignment
+ * @param hashKey A function or macro taking a key and returning a uint64_t hash that spreads its bits
+ * @param keysEqual A function or macro taking two keys and returning non-zero if they are equal
+ */
+#define DEFINE_HASHTABLE(Name, KeyType, ValueType, hashKey, keysEqual) \
+\
+struct Name##Entry { \
+    KeyType key; /* holds the key */ \
+    ValueType value; /* holds the value associated with the key */ \
+    uint32_t tag; /* holds the low bits of the key's hash with the top bit set, 0 when the slot is empty */ \
+}; \
+\
+struct Name { \
+    int capacity; /* holds the number of slots in the entry array, a power of two */ \
+    int numEntries; /* holds the number of key-value pairs stored in the table */ \
+    double maxLoadFactor; /* holds the fraction of slots that can be filled before the table grows */ \
+    struct Name##Entry *entries; /* holds the array of entries */ \
+}; \
+\
+static inline struct Name* construct##Name (int capacity, double maxLoadFactor) { \
+    struct Name *table = malloc(sizeof(struct Name)); \
+    table->capacity = roundUpToPowerOfTwo(capacity > 0 ? capacity : 1); \
+    table->numEntries = 0; \
+    table->maxLoadFactor = maxLoadFactor > 0 && maxLoadFactor < 1 ? maxLoadFactor : 0.9; /* there must always be a free slot to stop probing at */ \
+    table->entries = calloc(table->capacity, sizeof(struct Name##Entry)); /* every slot starts with a 0 tag, empty */ \
+    return table; \
+} \
+\
+static inline void destroy##Name (struct Name *table) { \
+    free(table->entries); \
+    free(table); \
+} \
+\
+static inline double get##Name##LoadFactor (struct Name *table) { \
+    return (double) table->numEntries / table->capacity; \
+} \
+\
+static inline int probeDistance##Name (struct Name *table, uint32_t tag, int index) { \
+    return (index - (int) (tag & (uint32_t) (table->capacity - 1))) & (table->capacity - 1); \
+} \
+\
+/* places an entry the Robin Hood way and returns the slot it ended up in */ \
+static inline int placeEntry##Name (struct Name *table, struct Name##Entry entry) { \
+    int index = (int) (entry.tag & (uint32_t) (table->capacity - 1)); \
+    int distance = 0; \
+    int placed = -1; \
+    while (table->entries[index].tag != 0) { \
+        int slotDistance = probeDistance##Name(table, table->entries[index].tag, index); \
+        if (slotDistance < distance) { /* the entry in this slot is closer to home than ours, so take its place */ \
+            struct Name##Entry displaced = table->entries[index]; \
+            table->entries[index] = entry; \
+            entry = displaced; \
+            distance = slotDistance; \
+            if (placed < 0) placed = index; \
+        } \
+        index = (index + 1) & (table->capacity - 1); \
+        distance++; \
+    } \
+    table->entries[index] = entry; \
+    return placed < 0 ? index : placed; \
+} \
+\
+static inline void grow##Name (struct Name *table) { \
+    struct Name##Entry *oldEntries = table->entries; \
+    int oldCapacity = table->capacity; \
+    table->capacity = oldCapacity * 2; \
+    table->entries = calloc(table->capacity, sizeof(struct Name##Entry)); \
+    for (int i = 0; i < oldCapacity; i++) { \
+        if (oldEntries[i].tag != 0) { \
+            placeEntry##Name(table, oldEntries[i]); \
+        } \
+    } \
+    free(oldEntries); \
+} \
+\
+/* finds the slot holding a key, -1 if it can't be found */ \
+static inline int findIndex##Name (struct Name *table, KeyType key, uint32_t tag) { \
+    int index = (int) (tag & (uint32_t) (table->capacity - 1)); \
+    int distance = 0; \
+    while (table->entries[index].tag != 0 && distance <= probeDistance##Name(table, table->entries[index].tag, index)) { \
+        if (table->entries[index].tag == tag && keysEqual(table->entries[index].key, key)) { /* only compare the keys when the tags match */ \
+            return index; \
+        } \
+        index = (index + 1) & (table->capacity - 1); \
+        distance++; \
+    } \
+    return -1; \
+} \
+\
+static inline ValueType* search##Name (struct Name *table, KeyType key) { \
+    int index = findIndex##Name(table, key, genericHashTag(hashKey(key))); \
+    return index >= 0 ? &table->entries[index].value : 0; \
+} \
+\
+static inline ValueType* getOrInsert##Name (struct Name *table, KeyType key, ValueType defaultValue) { \
+    uint32_t tag = genericHashTag(hashKey(key)); \
+    int index = findIndex##Name(table, key, tag); \
+    if (index >= 0) { \
+        return &table->entries[index].value; \
+    } \
+    if (table->numEntries + 1 > table->maxLoadFactor * table->capacity) { \
+        grow##Name(table); \
+    } \
+    struct Name##Entry entry; \
+    entry.key = key; \
+    entry.value = defaultValue; \
+    entry.tag = tag; \
+    table->numEntries++; \
+    return &table->entries[placeEntry##Name(table, entry)].value; \
+} \
+\
+static inline void upsert##Name (struct Name *table, KeyType key, ValueType value) { \
+    *getOrInsert##Name(table, key, value) = value; \
+} \
+\
+/* removes a key, shifting the entries after it back a slot so no tombstones are needed */ \
+static inline int removeFrom##Name (struct Name *table, KeyType key) { \
+    int index = findIndex##Name(table, key, genericHashTag(hashKey(key))); \
+    if (index < 0) return 0; /* nothing to remove */ \
+    int next = (index + 1) & (table->capacity - 1); \
+    while (table->entries[next].tag != 0 && probeDistance##Name(table, table->entries[next].tag, next) > 0) { \
+        table->entries[index] = table->entries[next]; /* shift the entry back a slot, closer to its home */ \
+        index = next; \
+        next = (next + 1) & (table->capacity - 1); \
+    } \
+    table->entries[index].tag = 0; /* the last shifted slot becomes empty */ \
+    table->numEntries--; \
+    return 1; \
+}
+
+#endif // GENERICHASHTABLE_H
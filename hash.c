@@ -0,0 +1,214 @@
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hash.h"
+
+
+/**
+ * A fairly efficient hashing fucntion written by Dan Bernstein.
+ * Dan Bernstein, 1990. DJB2 Hashing function [computer program]. Available from: https://groups.google.com/forum/?nomobile=true#!searchin/comp.lang.c/Dan$20Bernstein$20%7Csort:date/comp.lang.c/VByoIO8GySs/2XN9iGTpgmsJ [Accessed 02 May 2020].
+ * Kept for compatibility, it goes through the key a byte at a time so wyHash is much faster on anything but tiny keys.
+ * The seed only moves where keys land, keys crafted to collide still collide whatever the seed is.
+ * @param key The key to hash
+ * @param length The length of the key in bytes
+ * @param seed The seed, 0 gives the original DJB2 hash
+ * @return the hash
+ */
+uint64_t djb2Hash (const void *key, size_t length, uint64_t seed) {// use an optimised hash function by Dan Bernstein
+    const unsigned char *str = key;
+    uint64_t hash = 5381 ^ seed; // start at 5381, special number
+
+    for (size_t i = 0; i < length; i++) { // loop through all the characters in the key
+        hash = ((hash << 5) + hash) + str[i]; // (hash * 2^5) + hash + c
+    }
+
+    return hash;
+}
+
+static const uint64_t wySecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+/**
+ * Multiplies two 64 bit numbers into a 128 bit result, storing the low half in a and the high half in b
+ */
+static inline void wyMultiply (uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = (__uint128_t) *a * *b;
+    *a = (uint64_t) product;
+    *b = (uint64_t) (product >> 64);
+#else // no 128 bit type, so build the product out of 32 bit halves
+    uint64_t highA = *a >> 32, lowA = (uint32_t) *a, highB = *b >> 32, lowB = (uint32_t) *b;
+    uint64_t highHigh = highA * highB, highLow = highA * lowB, lowHigh = lowA * highB, lowLow = lowA * lowB;
+    uint64_t partial = lowLow + (highLow << 32);
+    uint64_t carry = partial < lowLow;
+    uint64_t low = partial + (lowHigh << 32);
+    carry += low < partial;
+    *a = low;
+    *b = highHigh + (highLow >> 32) + (lowHigh >> 32) + carry;
+#endif
+}
+
+/**
+ * Multiplies two 64 bit numbers and folds the 128 bit result back into 64 bits
+ */
+static inline uint64_t wyMix (uint64_t a, uint64_t b) {
+    wyMultiply(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyRead8 (const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value)); // compiles to a single unaligned load
+    return value;
+}
+
+static inline uint64_t wyRead4 (const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * A hash function that works through the key 8 or 16 bytes at a time using 64 bit multiplies, based on wyhash.
+ * Keys up to 16 bytes are covered by two overlapping loads with no loop at all, and keys of our usual 20 to 60
+ * bytes take at most three rounds of the 16 byte loop.
+ * Wang Yi, 2019. wyhash [computer program]. Available from: https://github.com/wangyi-fudan/wyhash [Accessed 14 October 2026].
+ * @param key The key to hash
+ * @param length The length of the key in bytes
+ * @param seed The seed, mixed in before the first round
+ * @return the hash
+ */
+uint64_t wyHash (const void *key, size_t length, uint64_t seed) {
+    const unsigned char *p = key;
+    seed ^= wyMix(seed ^ wySecret[0], wySecret[1]);
+    uint64_t a, b;
+
+    if (length <= 16) {
+        if (length >= 4) { // two pairs of overlapping 4 byte loads cover every byte of the key
+            a = (wyRead4(p) << 32) | wyRead4(p + ((length >> 3) << 2));
+            b = (wyRead4(p + length - 4) << 32) | wyRead4(p + length - 4 - ((length >> 3) << 2));
+        } else if (length > 0) {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) { // three independent lanes so the multiplies can run in parallel
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = wyMix(wyRead8(p) ^ wySecret[1], wyRead8(p + 8) ^ seed);
+                seed1 = wyMix(wyRead8(p + 16) ^ wySecret[2], wyRead8(p + 24) ^ seed1);
+                seed2 = wyMix(wyRead8(p + 32) ^ wySecret[3], wyRead8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = wyMix(wyRead8(p) ^ wySecret[1], wyRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = wyRead8(p + i - 16); // the last 16 bytes, overlapping what was already hashed
+        b = wyRead8(p + i - 8);
+    }
+
+    a ^= wySecret[1];
+    b ^= seed;
+    wyMultiply(&a, &b);
+    return wyMix(a ^ wySecret[0] ^ length, b ^ wySecret[1]);
+}
+
+#define SIP_ROTATE(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+/**
+ * One SipRound, mixes the four words of SipHash state
+ */
+static inline void sipRound (uint64_t *v0, uint64_t *v1, uint64_t *v2, uint64_t *v3) {
+    *v0 += *v1; *v1 = SIP_ROTATE(*v1, 13); *v1 ^= *v0; *v0 = SIP_ROTATE(*v0, 32);
+    *v2 += *v3; *v3 = SIP_ROTATE(*v3, 16); *v3 ^= *v2;
+    *v0 += *v3; *v3 = SIP_ROTATE(*v3, 21); *v3 ^= *v0;
+    *v2 += *v1; *v1 = SIP_ROTATE(*v1, 17); *v1 ^= *v2; *v2 = SIP_ROTATE(*v2, 32);
+}
+
+/**
+ * SipHash-2-4 with a 128 bit key, given as two halves
+ * Jean-Philippe Aumasson and Daniel J. Bernstein, 2012. SipHash: a fast short-input PRF. Available from: https://www.aumasson.jp/siphash/siphash.pdf [Accessed 14 October 2026].
+ * @param key The data to hash
+ * @param length The length of the data in bytes
+ * @param k0 The first half of the key, read as little endian
+ * @param k1 The second half of the key
+ * @return the hash
+ */
+uint64_t sipHash24 (const void *key, size_t length, uint64_t k0, uint64_t k1) {
+    const unsigned char *p = key;
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ull;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dull;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ull;
+    uint64_t v3 = k1 ^ 0x7465646279746573ull;
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t m = 0;
+        for (int j = 0; j < 8; j++) { // little endian whatever the machine is
+            m |= (uint64_t) p[i + j] << (8 * j);
+        }
+        v3 ^= m;
+        sipRound(&v0, &v1, &v2, &v3);
+        sipRound(&v0, &v1, &v2, &v3);
+        v0 ^= m;
+    }
+    uint64_t last = (uint64_t) length << 56; // the length goes in the top byte of the last word
+    for (int j = 0; i + j < length; j++) {
+        last |= (uint64_t) p[i + j] << (8 * j);
+    }
+    v3 ^= last;
+    sipRound(&v0, &v1, &v2, &v3);
+    sipRound(&v0, &v1, &v2, &v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for (int round = 0; round < 4; round++) {
+        sipRound(&v0, &v1, &v2, &v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * A keyed hash function for keys that may have been chosen by an attacker, SipHash-2-4. Without knowing the seed
+ * nobody can predict which keys collide, at the cost of being a few times slower than wyHash.
+ * @param key The key to hash
+ * @param length The length of the key in bytes
+ * @param seed The seed, expanded into SipHash's 128 bit key
+ * @return the hash
+ */
+uint64_t sipHash (const void *key, size_t length, uint64_t seed) {
+    return sipHash24(key, length, seed, mixHash(seed ^ wySecret[2]));
+}
+
+/**
+ * Makes a seed that can't be guessed, from the operating system's random source. If that can't be read the time, a
+ * counter and an address are mixed together instead, which differ between tables but can't be relied on against an
+ * attacker.
+ * @return The seed
+ */
+uint64_t randomSeed () {
+    uint64_t seed = 0;
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd >= 0) {
+        ssize_t bytesRead = read(fd, &seed, sizeof(seed));
+        close(fd);
+        if (bytesRead == (ssize_t) sizeof(seed)) {
+            return seed;
+        }
+    }
+    static uint64_t counter = 0;
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    seed = (uint64_t) time.tv_sec * 1000000000ull + (uint64_t) time.tv_nsec;
+    seed ^= (uint64_t) (uintptr_t) &seed;
+    return mixHash(seed + __atomic_add_fetch(&counter, 0x9e3779b97f4a7c15ull, __ATOMIC_RELAXED));
+}
@@ -0,0 +1,47 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * A function that hashes a key of the given length in bytes, the key doesn't need to be null terminated. Tables pass
+ * their own seed, so keys that collide in one table don't collide in another.
+ */
+typedef uint64_t (*HashFunction)(const void *key, size_t length, uint64_t seed);
+
+uint64_t djb2Hash (const void *key, size_t length, uint64_t seed);
+uint64_t wyHash (const void *key, size_t length, uint64_t seed);
+uint64_t sipHash (const void *key, size_t length, uint64_t seed);
+uint64_t randomSeed ();
+
+/**
+ * Mixes every bit of a hash into every other, based on the splitmix64 finalizer. Tables mix hashes before masking or
+ * range reducing them, so hashes with weak low or high bits like DJB2 still spread evenly over the buckets.
+ * @param hash The hash to mix
+ * @return The mixed hash
+ */
+static inline uint64_t mixHash (uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+/**
+ * Rounds a number up to the next power of two
+ * @param n The number to round, at most 2^30
+ * @return The smallest power of two no less than n
+ */
+static inline int roundUpToPowerOfTwo (int n) {
+    int power = 1;
+    while (power < n) {
+        power <<= 1;
+    }
+    return power;
+}
+
+#endif // HASH_H
@@ -0,0 +1,1180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+
+#include "hashtable.h"
+
+
+/**
+ * A function to allocate an array of top level buckets, every bucket starts empty with a 0 pointer
+ * @param numBuckets The number of top level buckets required
+ * @return The allocated array of buckets
+ */
+struct Bucket** allocateBuckets (int numBuckets) {
+    return calloc(numBuckets, sizeof(struct Bucket *)); // a single zeroed allocation, no buckets are needed until keys are added
+}
+
+/**
+ * A function that returns the default options for a hashtable, a small table that grows as keys are added
+ * @return The default options
+ */
+struct HashTableOptions defaultHashTableOptions () {
+    struct HashTableOptions options;
+    options.numBuckets = 16; // start small, the table grows as needed
+    options.maxLoadFactor = 1.0; // grow once there is more than one entry per bucket on average
+    options.rehashStep = 4; // migrate a few buckets per operation so no single call stalls
+    options.hashFunction = wyHash; // use the fast hash, djb2Hash is there for compatibility
+    options.seed = randomSeed(); // so nobody can work out ahead of time which keys will collide
+    options.maxChainLength = 64; // far longer than any chain a good hash makes at a sensible load factor
+    options.powerOfTwoBuckets = 1; // index buckets with a mask rather than a multiply
+    options.internKeys = 0; // point at the caller's keys rather than copying them
+    return options;
+}
+
+/**
+ * A function that creates a hashtable struct with the options provided
+ * @param options The options to construct the table with
+ * @return The constructed HashTable struct.
+ */
+struct HashTable* constructHashTableWithOptions (const struct HashTableOptions *options) {
+    struct HashTable *table = malloc(sizeof(struct HashTable)); // creates a new Hashtable
+    table->powerOfTwoBuckets = options->powerOfTwoBuckets;
+    table->numBuckets = options->numBuckets > 0 ? options->numBuckets : 1; // store the number of buckets available
+    if (table->powerOfTwoBuckets) {
+        table->numBuckets = roundUpToPowerOfTwo(table->numBuckets);
+    }
+    initNodePool(&table->bucketPool, sizeof(struct Bucket), 1024); // every bucket comes out of blocks owned by the table
+    table->buckets = allocateBuckets(table->numBuckets);
+    table->numNewBuckets = 0; // the table is not growing yet
+    table->newBuckets = 0;
+    table->rehashIndex = 0;
+    table->numEntries = 0;
+    table->maxLoadFactor = options->maxLoadFactor;
+    table->rehashStep = options->rehashStep > 0 ? options->rehashStep : 1;
+    table->hashFunction = options->hashFunction != 0 ? options->hashFunction : wyHash;
+    table->seed = options->seed;
+    table->maxChainLength = options->maxChainLength;
+    table->numReseeds = 0;
+    table->keyPool = 0;
+    if (options->internKeys) {
+        table->keyPool = malloc(sizeof(struct StringPool));
+        initStringPool(table->keyPool);
+    }
+#ifdef HASHTABLE_STATS
+    memset(&table->counters, 0, sizeof(table->counters));
+#endif
+    return table;
+}
+
+/**
+ * A function that creates a hashtable struct, allocates enough memory as demanded by the number of buckets wanted.
+ * The table never grows, use constructHashTableWithOptions for a table that resizes itself.
+ * @param numBuckets The number of top level buckets required
+ * @return The constructed HashTable struct.
+ */
+struct HashTable* constructHashTable (int numBuckets) {
+    struct HashTableOptions options = defaultHashTableOptions();
+    options.numBuckets = numBuckets;
+    options.maxLoadFactor = 0; // a fixed number of buckets for the table's whole lifetime
+    options.powerOfTwoBuckets = 0; // keep exactly the number of buckets asked for
+    return constructHashTableWithOptions(&options);
+}
+
+/**
+ * A function to delete and free the memory of a hashtable and all bucket chains. Every bucket came from the table's
+ * pool so they are all freed a block at a time rather than walking the chains.
+ * @param table The table to delete
+ */
+void destroyHashTable (struct HashTable *table) {
+    releaseNodePool(&table->bucketPool);
+    if (table->keyPool != 0) {
+        releaseStringPool(table->keyPool);
+        free(table->keyPool);
+    }
+    free(table->buckets);
+    free(table->newBuckets); // only set if the table was destroyed part way through growing
+    free(table);
+}
+
+/**
+ * Works out which bucket of an array a hash belongs in without a division. The hash is mixed first, then masked when
+ * the number of buckets is a power of two, or otherwise mapped onto the range with Lemire's multiply and shift.
+ * Daniel Lemire, 2016. A fast alternative to the modulo reduction. Available from: https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/ [Accessed 14 October 2026].
+ * @param table The table the array belongs to
+ * @param keyHash The hash of the key
+ * @param numBuckets The number of buckets in the array
+ * @return The index of the bucket
+ */
+int bucketIndex (struct HashTable *table, uint64_t keyHash, int numBuckets) {
+    uint64_t mixed = mixHash(keyHash);
+    if (table->powerOfTwoBuckets) {
+        return (int) (mixed & (uint64_t) (numBuckets - 1));
+    }
+    return (int) (((mixed >> 32) * (uint64_t) numBuckets) >> 32); // the top 32 bits scaled onto [0, numBuckets)
+}
+
+/**
+ * Finds the top level bucket a key belongs in. While the table is growing a key stays in the old array until its
+ * bucket there has been migrated, so there is only ever one chain to look at.
+ * @param table The table to look in
+ * @param keyHash The hash of the key to find the bucket for
+ * @return A pointer to the top level bucket the key belongs in
+ */
+struct Bucket** locateBucket (struct HashTable *table, uint64_t keyHash) {
+    int boundedHash = bucketIndex(table, keyHash, table->numBuckets);
+    if (table->newBuckets != 0 && boundedHash < table->rehashIndex) { // this bucket has already been migrated
+        return &table->newBuckets[bucketIndex(table, keyHash, table->numNewBuckets)];
+    }
+    return &table->buckets[boundedHash];
+}
+
+/**
+ * Moves up to the given number of bucket chains from the old array into the new one if the table is growing, once
+ * every bucket has been moved the old array is freed and the new one takes its place.
+ * @param table The table to migrate the buckets of
+ * @param count The number of non-empty buckets to migrate
+ */
+void migrateBuckets (struct HashTable *table, int count) {
+    if (table->newBuckets == 0) return; // nothing to do unless the table is growing
+    int emptyVisits = count * 10; // bound the number of empty buckets skipped so a sparse table doesn't stall either
+
+    while (count > 0 && emptyVisits > 0 && table->rehashIndex < table->numBuckets) {
+        struct Bucket *bucket = table->buckets[table->rehashIndex];
+        if (bucket != 0) {
+            count--;
+        } else {
+            emptyVisits--;
+        }
+        while (bucket != 0) { // move every bucket in the chain onto the front of its new chain
+            struct Bucket *next = bucket->chainedBucket;
+            int boundedHash = bucketIndex(table, bucket->hash, table->numNewBuckets); // reuse the stored hash rather than hashing the key again
+            bucket->chainedBucket = table->newBuckets[boundedHash];
+            table->newBuckets[boundedHash] = bucket;
+            bucket = next;
+        }
+        table->buckets[table->rehashIndex] = 0;
+        table->rehashIndex++;
+    }
+
+    if (table->rehashIndex == table->numBuckets) { // every bucket has been moved so swap the new array in
+        free(table->buckets);
+        table->buckets = table->newBuckets;
+        table->numBuckets = table->numNewBuckets;
+        table->newBuckets = 0;
+        table->numNewBuckets = 0;
+        table->rehashIndex = 0;
+    }
+}
+
+/**
+ * Starts growing the table if it has gone over its maximum load factor. The buckets are then migrated a few at a
+ * time by each following operation rather than all at once.
+ * @param table The table to check
+ */
+void growIfNeeded (struct HashTable *table) {
+    if (table->maxLoadFactor <= 0 || table->newBuckets != 0) return; // fixed size or already growing
+    if (table->numEntries <= table->maxLoadFactor * table->numBuckets) return;
+    if (table->numBuckets > INT_MAX / 2) return; // can't grow any further
+
+    table->numNewBuckets = table->numBuckets * 2;
+    table->newBuckets = allocateBuckets(table->numNewBuckets);
+    table->rehashIndex = 0;
+    COUNT_STAT(table, resizes, 1);
+}
+
+/**
+ * Gets the current load factor of the table, the average number of entries per top level bucket
+ * @param table The table to get the load factor of
+ * @return The load factor
+ */
+double getLoadFactor (struct HashTable *table) {
+    int numBuckets = table->newBuckets != 0 ? table->numNewBuckets : table->numBuckets; // measure against the array being grown into
+    return (double) table->numEntries / numBuckets;
+}
+
+/**
+ * Checks whether the table can still rehash itself to break up a long chain. Once a table hashes with sipHash its
+ * chains can't be aimed at, so a long chain there is a key that was added many times and rehashing won't shorten it.
+ * A table with a hash function of its own can only be given a new seed once, since it can't be swapped for sipHash.
+ * @param table The table to check
+ * @return 1 if the table can rehash, 0 otherwise
+ */
+int canReseed (struct HashTable *table) {
+    if (table->maxChainLength <= 0 || table->numReseeds >= MAX_RESEEDS || table->hashFunction == sipHash) return 0;
+    return table->hashFunction == wyHash || table->hashFunction == djb2Hash || table->numReseeds == 0;
+}
+
+/**
+ * Rehashes every key of the table into a fresh array after a long chain was found. A table hashed with wyHash is first
+ * given a new seed, since the chain may just be bad luck, and if that doesn't help it switches to sipHash, whose
+ * collisions can't be found without the seed. djb2Hash collides whatever the seed is so it switches straight away. A
+ * table that was growing finishes growing as part of the rehash. Buckets are relinked rather than moved, so any
+ * pointer into the table stays valid.
+ * @param table The table to rehash
+ */
+void reseedHashTable (struct HashTable *table) {
+    if (table->hashFunction == djb2Hash || (table->hashFunction == wyHash && table->numReseeds > 0)) {
+        table->hashFunction = sipHash;
+    }
+    table->seed = randomSeed();
+    table->numReseeds++;
+    COUNT_STAT(table, reseeds, 1);
+
+    int numBuckets = table->newBuckets != 0 ? table->numNewBuckets : table->numBuckets;
+    struct Bucket **buckets = allocateBuckets(numBuckets);
+    for (int pass = 0; pass < 2; pass++) { // the old array from rehashIndex on, then the array being grown into
+        struct Bucket **from = pass == 0 ? table->buckets : table->newBuckets;
+        int start = pass == 0 ? table->rehashIndex : 0;
+        int end = pass == 0 ? table->numBuckets : table->numNewBuckets;
+        for (int i = start; i < end; i++) {
+            struct Bucket *bucket = from[i];
+            while (bucket != 0) {
+                struct Bucket *next = bucket->chainedBucket;
+                bucket->hash = table->hashFunction(bucketKey(bucket), bucket->keyLength, table->seed);
+                int boundedHash = bucketIndex(table, bucket->hash, numBuckets);
+                bucket->chainedBucket = buckets[boundedHash];
+                buckets[boundedHash] = bucket;
+                bucket = next;
+            }
+        }
+    }
+
+    free(table->buckets);
+    free(table->newBuckets);
+    table->buckets = buckets;
+    table->numBuckets = numBuckets;
+    table->newBuckets = 0;
+    table->numNewBuckets = 0;
+    table->rehashIndex = 0;
+}
+
+/**
+ * Rehashes the table if a lookup had to walk a chain far longer than the load factor explains, which happens when the
+ * keys were chosen to collide. A table isn't rehashed for a chain that is only long because the table is overloaded.
+ * @param table The table the lookup was in
+ * @param probes The number of buckets the lookup compared
+ */
+void checkChainLength (struct HashTable *table, int probes) {
+    if (probes <= table->maxChainLength || !canReseed(table)) return;
+    if (probes <= CHAIN_LOAD_MULTIPLE * getLoadFactor(table)) return;
+    reseedHashTable(table);
+}
+
+/**
+ * Counts the buckets of a chain, stopping once the count is past what checkChainLength would let through, so adding
+ * to an attacked chain costs no more than a lookup of it
+ * @param table The table the chain is in
+ * @param bucket The first bucket of the chain
+ * @return The length of the chain, or a length past the limit if it is longer
+ */
+int boundedChainLength (struct HashTable *table, struct Bucket *bucket) {
+    double attackLength = CHAIN_LOAD_MULTIPLE * getLoadFactor(table);
+    int limit = attackLength > table->maxChainLength ? (int) attackLength + 1 : table->maxChainLength + 1;
+    int length = 0;
+    while (bucket != 0 && length < limit) {
+        length++;
+        bucket = bucket->chainedBucket;
+    }
+    return length;
+}
+
+/**
+ * Sets the key a bucket holds. A short key is copied into the bucket so comparing it doesn't need another cache miss,
+ * a longer key is pointed to and must stay in memory as long as the bucket does.
+ * @param bucket The bucket to set the key of
+ * @param key The key
+ * @param keyLength The length of the key in bytes
+ */
+void setBucketKey (struct Bucket *bucket, char *key, uint32_t keyLength) {
+    bucket->keyLength = keyLength;
+    if (keyLength < INLINE_KEY_SIZE) {
+        memcpy(bucket->key.bytes, key, keyLength);
+        bucket->key.bytes[keyLength] = '\0'; // so an inline key can be used as a string too
+    } else {
+        bucket->key.pointer = key;
+    }
+}
+
+/**
+ * Gets the key a new bucket should point to. A table that interns keys interns every key in its own pool, so a key is
+ * only stored once however many times it is added and always gets the same handle, and the caller's key can be freed
+ * or reused straight away. A short key is still copied into its bucket as well, so chain walks don't leave the bucket.
+ * @param table The table the bucket is being added to
+ * @param key The caller's key
+ * @param keyLength The length of the key in bytes
+ * @param handle Set to the key's handle in the table's pool if it isn't 0, INVALID_STRING_HANDLE if the table doesn't
+ *               intern keys or its pool is full
+ * @return The key to store, the caller's own unless the table interned it, 0 if the table interns keys and its pool is
+ *         full, since the caller may not keep its key
+ */
+char* ownKey (struct HashTable *table, char *key, uint32_t keyLength, uint32_t *handle) {
+    uint32_t interned = table->keyPool != 0 ? internString(table->keyPool, key, keyLength) : INVALID_STRING_HANDLE;
+    if (handle != 0) {
+        *handle = interned;
+    }
+    if (interned == INVALID_STRING_HANDLE) return table->keyPool != 0 ? 0 : key;
+    if (keyLength < INLINE_KEY_SIZE) return key; // copied into the bucket, which doesn't need the pool's copy
+    return poolString(table->keyPool, interned);
+}
+
+/**
+ * Gets the handle of a bucket's key in its table's pool. Every key of a table that interns keys has one, and two keys
+ * of the same table are equal exactly when their handles are, so other code can keep and compare handles instead of
+ * the keys themselves.
+ * @param table The table the bucket is in
+ * @param bucket The bucket
+ * @return The handle of the bucket's key, INVALID_STRING_HANDLE if the table doesn't intern keys
+ */
+uint32_t getKeyHandle (struct HashTable *table, struct Bucket *bucket) {
+    if (table->keyPool == 0) return INVALID_STRING_HANDLE;
+    return findInternedString(table->keyPool, bucketKey(bucket), bucket->keyLength);
+}
+
+/**
+ * A function to take a key-value and place them into a new bucket. The given chain is then chained onto the new
+ * bucket, so adding takes the same time however long the chain is.
+ * @param pool The pool to take the new bucket from.
+ * @param bucket The bucket chain to chain onto the new bucket.
+ * @param key The key value.
+ * @param keyLength The length of the key.
+ * @param keyHash The hash of the key.
+ * @param value The value corresponding with the key.
+ * @return The bucket chain, starting with the new bucket.
+ */
+struct Bucket* chainValue(struct NodePool *pool, struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash, int value) {
+    struct Bucket *newBucket = poolAllocate(pool);
+    newBucket->value = value; // sets the key-pair value
+    setBucketKey(newBucket, key, keyLength);
+    newBucket->hash = keyHash; // keeps the hash so lookups and resizing don't need to hash the key again
+    newBucket->chainedBucket = bucket; // the rest of the chain follows the new one
+    return newBucket;
+}
+
+/**
+ * Adds the given key-pair value to the hashtable, the key doesn't need to be null terminated
+ * @param table The table to add to
+ * @param key The key to add
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ */
+void addToTableWithLength (struct HashTable *table, char *key, uint32_t keyLength, int value) {
+    addToTableInternedWithLength(table, key, keyLength, value);
+}
+
+/**
+ * Adds the given key-pair value to the hashtable
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ */
+void addToTable (struct HashTable *table, char *key, int value) {
+    addToTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Adds the given key-pair value to the hashtable and gets the handle the key was interned with, the key doesn't need
+ * to be null terminated
+ * @param table The table to add to
+ * @param key The key to add
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ * @return The handle of the key in the table's pool, the same as every earlier add of an equal key was given,
+ *         INVALID_STRING_HANDLE if the table doesn't intern keys, or if its pool is full, in which case nothing is added
+ */
+uint32_t addToTableInternedWithLength (struct HashTable *table, char *key, uint32_t keyLength, int value) {
+    return addToTableWithHash(table, key, keyLength, table->hashFunction(key, keyLength, table->seed), value);
+}
+
+/**
+ * Adds the given key-pair value to the hashtable when the caller already has the key's hash. The hash must have been
+ * made by the table's hash function and seed, which change if the table rehashes itself.
+ * @param table The table to add to
+ * @param key The key to add, not necessarily null terminated
+ * @param keyLength The length of the key in bytes
+ * @param keyHash The hash of the key
+ * @param value The corresponding value to add
+ * @return The handle of the key in the table's pool, INVALID_STRING_HANDLE if the table doesn't intern keys, or if its
+ *         pool is full, in which case nothing is added
+ */
+uint32_t addToTableWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash, int value) {
+    migrateBuckets(table, table->rehashStep);
+    struct Bucket **bucket = locateBucket(table, keyHash);
+    uint32_t handle;
+    char *owned = ownKey(table, key, keyLength, &handle);
+    if (owned == 0) return INVALID_STRING_HANDLE; // the pool is full and the caller's key can't be borrowed
+    *bucket = chainValue(&table->bucketPool, *bucket, owned, keyLength, keyHash, value);
+    table->numEntries++;
+    COUNT_STAT(table, inserts, 1);
+    if (canReseed(table)) { // a client that only ever adds can still build a long chain
+        checkChainLength(table, boundedChainLength(table, *bucket));
+    }
+    growIfNeeded(table);
+    return handle;
+}
+
+/**
+ * Adds the given key-pair value to the hashtable and gets the handle the key was interned with
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ * @return The handle of the key in the table's pool, INVALID_STRING_HANDLE if the table doesn't intern keys, or if its
+ *         pool is full, in which case nothing is added
+ */
+uint32_t addToTableInterned (struct HashTable *table, char *key, int value) {
+    return addToTableInternedWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Checks whether a bucket holds the key given. The stored hashes are compared first so the key's characters are only
+ * compared when the hashes match, and a short key is compared from within the bucket itself.
+ * @param bucket The bucket to check
+ * @param key The key to check for
+ * @param keyLength The length of the key
+ * @param keyHash The hash of the key
+ * @return 1 if the bucket holds the key, 0 otherwise
+ */
+int bucketHasKey (struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash) {
+    if (bucket->hash != keyHash || bucket->keyLength != keyLength) return 0;
+    if (keyLength < INLINE_KEY_SIZE) {
+        return memcmp(bucket->key.bytes, key, keyLength) == 0;
+    }
+    return bucket->key.pointer == key || memcmp(bucket->key.pointer, key, keyLength) == 0;
+}
+
+/**
+ * Searches a bucket and its chain for the key provided, counting how many buckets are compared on the way
+ * @param bucket The bucket to search
+ * @param key The key to search for
+ * @param keyLength The length of the key
+ * @param keyHash The hash of the key
+ * @param probes Set to the number of buckets compared
+ * @return The bucket with the key in it.
+ */
+struct Bucket* probeBucket (struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash, int *probes) {
+    int count = 0;
+    while (bucket != 0) { // walk the chain until it ends
+        count++;
+        if (bucketHasKey(bucket, key, keyLength, keyHash)) {
+            break;
+        }
+        bucket = bucket->chainedBucket;
+    }
+    *probes = count;
+    return bucket;
+}
+
+/**
+ * Searches a bucket and it chain for the key provided
+ * @param bucket The bucket to search
+ * @param key The key to serch for
+ * @param keyLength The length of the key
+ * @param keyHash The hash of the key
+ * @return The bucket with the key in it.
+ */
+struct Bucket* searchBucket (struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash) {
+    int probes;
+    return probeBucket(bucket, key, keyLength, keyHash, &probes);
+}
+
+/**
+ * Searches the table for a key by hashing it and searching the bucket at that index, the key doesn't need to be null
+ * terminated.
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The bucket the key is in
+ */
+struct Bucket* searchTableWithLength (struct HashTable *table, char *key, uint32_t keyLength) {
+    return searchTableWithHash(table, key, keyLength, table->hashFunction(key, keyLength, table->seed));
+}
+
+/**
+ * Searches the table for a key when the caller already has the key's hash, made by the table's hash function and seed
+ * @param table The table to search through
+ * @param key The key to search for, not necessarily null terminated
+ * @param keyLength The length of the key in bytes
+ * @param keyHash The hash of the key
+ * @return The bucket the key is in
+ */
+struct Bucket* searchTableWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash) {
+    migrateBuckets(table, table->rehashStep);
+    int probes;
+    struct Bucket *bucket = probeBucket(*locateBucket(table, keyHash), key, keyLength, keyHash, &probes);
+    RECORD_PROBES(table, probes, bucket != 0);
+    checkChainLength(table, probes);
+    return bucket;
+}
+
+/**
+ * Searches the table for a key by hashing it and searching the bucket at that index.
+ * @param table The table to search through
+ * @param key The key to search for
+ * @return The bucket the key is in
+ */
+struct Bucket* searchTable (struct HashTable *table, char *key) {
+    return searchTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * Searches the table for a group of at most BATCH_GROUP_SIZE keys. Every key is hashed and its top level bucket
+ * prefetched before any of them is read, then the chains are walked together a bucket at a time, prefetching the next
+ * bucket of each chain, so the cache misses of the whole group overlap rather than being waited on one after another.
+ * @param table The table to search through
+ * @param keys The keys to search for
+ * @param keyLengths The length of each key in bytes
+ * @param groupSize The number of keys in the group
+ * @param results Set to the bucket each key is in, 0 for a key that isn't in the table
+ */
+void searchTableGroup (struct HashTable *table, char *keys[], const uint32_t keyLengths[], int groupSize, struct Bucket *results[]) {
+    uint64_t hashes[BATCH_GROUP_SIZE];
+    struct Bucket **heads[BATCH_GROUP_SIZE];
+    struct Bucket *buckets[BATCH_GROUP_SIZE];
+    int probes[BATCH_GROUP_SIZE];
+
+    for (int i = 0; i < groupSize; i++) { // hash every key and start loading its top level bucket
+        hashes[i] = table->hashFunction(keys[i], keyLengths[i], table->seed);
+        heads[i] = locateBucket(table, hashes[i]);
+        __builtin_prefetch(heads[i]);
+        results[i] = 0;
+        probes[i] = 0;
+    }
+    for (int i = 0; i < groupSize; i++) { // start loading the first bucket of every chain
+        buckets[i] = *heads[i];
+        if (buckets[i] != 0) {
+            __builtin_prefetch(buckets[i]);
+        } else {
+            RECORD_PROBES(table, 0, 0);
+        }
+    }
+
+    int pending = groupSize;
+    while (pending > 0) { // move every unfinished chain on by one bucket per pass
+        pending = 0;
+        for (int i = 0; i < groupSize; i++) {
+            struct Bucket *bucket = buckets[i];
+            if (bucket == 0) continue; // this key has already been found or its chain has ended
+            probes[i]++;
+            if (bucketHasKey(bucket, keys[i], keyLengths[i], hashes[i])) {
+                results[i] = bucket;
+                buckets[i] = 0;
+                RECORD_PROBES(table, probes[i], 1);
+                continue;
+            }
+            buckets[i] = bucket->chainedBucket;
+            if (buckets[i] != 0) {
+                __builtin_prefetch(buckets[i]);
+                pending++;
+            } else {
+                RECORD_PROBES(table, probes[i], 0);
+            }
+        }
+    }
+
+    int maxProbes = 0;
+    for (int i = 0; i < groupSize; i++) {
+        maxProbes = probes[i] > maxProbes ? probes[i] : maxProbes;
+    }
+    checkChainLength(table, maxProbes); // after the whole group, the buckets found stay where they are
+}
+
+/**
+ * Searches the table for many keys at once, the keys don't need to be null terminated. The keys are looked up in
+ * groups so the memory of a group can be loaded in parallel, which is much faster than searching for them one at a
+ * time when the table doesn't fit in cache.
+ * @param table The table to search through
+ * @param keys The keys to search for
+ * @param keyLengths The length of each key in bytes
+ * @param numKeys The number of keys
+ * @param results Set to the bucket each key is in, 0 for a key that isn't in the table
+ */
+void searchTableBatchWithLength (struct HashTable *table, char *keys[], const uint32_t keyLengths[], int numKeys, struct Bucket *results[]) {
+    for (int start = 0; start < numKeys; start += BATCH_GROUP_SIZE) {
+        migrateBuckets(table, table->rehashStep); // once per group, so no bucket moves while a group is being searched
+        int groupSize = numKeys - start < BATCH_GROUP_SIZE ? numKeys - start : BATCH_GROUP_SIZE;
+        searchTableGroup(table, &keys[start], &keyLengths[start], groupSize, &results[start]);
+    }
+}
+
+/**
+ * Searches the table for many keys at once, looking them up in groups so the memory of a group can be loaded in
+ * parallel.
+ * @param table The table to search through
+ * @param keys The keys to search for
+ * @param numKeys The number of keys
+ * @param results Set to the bucket each key is in, 0 for a key that isn't in the table
+ */
+void searchTableBatch (struct HashTable *table, char *keys[], int numKeys, struct Bucket *results[]) {
+    uint32_t keyLengths[BATCH_GROUP_SIZE];
+    for (int start = 0; start < numKeys; start += BATCH_GROUP_SIZE) {
+        int groupSize = numKeys - start < BATCH_GROUP_SIZE ? numKeys - start : BATCH_GROUP_SIZE;
+        for (int i = 0; i < groupSize; i++) {
+            keyLengths[i] = strlen(keys[start + i]);
+        }
+        searchTableBatchWithLength(table, &keys[start], keyLengths, groupSize, &results[start]);
+    }
+}
+
+/**
+ * Prints out the value of the key specified
+ * @param table The table to search for the key in and print the value of it
+ * @param key The key to search for and print the value of
+ */
+void printKeyValue (struct HashTable *table, char *key) {
+    struct Bucket *bucket = searchTable(table, key); // searches for the bucket with the key
+    if (bucket != 0) {
+        printf("%s: %d\n", key, bucket->value); // prints the value if it is found
+    } else {
+        printf("%s doesn't exist!\n", key); // prints an error if it cant be found
+    }
+}
+
+/**
+ * A function to give a bucket back to the pool it came from. The bucket is marked as freed first so iterating over the
+ * pool skips it until it is handed out again.
+ * @param pool The pool the bucket came from
+ * @param bucket The bucket to give back
+ */
+void releaseBucket (struct NodePool *pool, struct Bucket *bucket) {
+    bucket->keyLength = FREED_KEY_LENGTH; // the pool only overwrites the first pointer of a freed node, so this survives
+    poolFree(pool, bucket);
+}
+
+/**
+ * A function to delete a bucket from a chain and free the memory. Then reforms the bucket chain without the specified bucket.
+ * @param pool The pool to give the deleted bucket back to.
+ * @param bucket The bucket chain to delete the bucket with the key in from.
+ * @param key The key corresponding to the bucket to be removed.
+ * @param keyLength The length of the key.
+ * @param keyHash The hash of the key.
+ * @param removed Set to 1 if a bucket was removed, left unchanged otherwise.
+ * @return The bucket chain without the deleted bucket.
+ */
+struct Bucket* reformChainExcluding(struct NodePool *pool, struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash, int *removed) {
+    struct Bucket **link = &bucket; // holds the pointer that leads to the bucket being looked at
+    while (*link != 0) {
+        struct Bucket *current = *link;
+        if (bucketHasKey(current, key, keyLength, keyHash)) {
+            *link = current->chainedBucket; // point past the bucket being removed
+            releaseBucket(pool, current); // frees the memory from the deleted bucket.
+            *removed = 1;
+            break;
+        }
+        link = &current->chainedBucket; // move on if the key was not found in this bucket
+    }
+    return bucket; // returns the chain, unchanged if the key wasn't in it
+}
+
+/**
+ * A function to remove the key from the table, the key doesn't need to be null terminated.
+ * @param table The hashtable to remove the key from.
+ * @param key The key to remove.
+ * @param keyLength The length of the key in bytes.
+ */
+void removeFromTableWithLength (struct HashTable *table, char *key, uint32_t keyLength) {
+    removeFromTableWithHash(table, key, keyLength, table->hashFunction(key, keyLength, table->seed));
+}
+
+/**
+ * A function to remove the key from the table when the caller already has the key's hash, made by the table's hash
+ * function and seed
+ * @param table The hashtable to remove the key from.
+ * @param key The key to remove, not necessarily null terminated.
+ * @param keyLength The length of the key in bytes.
+ * @param keyHash The hash of the key.
+ */
+void removeFromTableWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash) {
+    migrateBuckets(table, table->rehashStep);
+    struct Bucket **bucket = locateBucket(table, keyHash); // Hashes the key and finds the top level bucket associated with it.
+    int removed = 0;
+    *bucket = reformChainExcluding(&table->bucketPool, *bucket, key, keyLength, keyHash, &removed); // Removes the key by removing it associated bucket.
+    table->numEntries -= removed;
+}
+
+/**
+ * A function to remove the key from the table.
+ * @param table The hashtable to remove the key from.
+ * @param key The key to remove.
+ */
+void removeFromTable (struct HashTable *table, char *key) {
+    removeFromTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * Removes many keys from the table at once, the keys don't need to be null terminated. The keys are removed in groups
+ * of BATCH_GROUP_SIZE, every top level bucket of a group being prefetched before any chain is walked, so the cache
+ * misses of the group overlap.
+ * @param table The table to remove the keys from
+ * @param keys The keys to remove
+ * @param keyLengths The length of each key in bytes
+ * @param numKeys The number of keys
+ * @return The number of keys that were removed
+ */
+long removeFromTableBatchWithLength (struct HashTable *table, char *keys[], const uint32_t keyLengths[], int numKeys) {
+    uint64_t hashes[BATCH_GROUP_SIZE];
+    struct Bucket **heads[BATCH_GROUP_SIZE];
+    long removed = 0;
+
+    for (int start = 0; start < numKeys; start += BATCH_GROUP_SIZE) {
+        migrateBuckets(table, table->rehashStep); // once per group, so no bucket moves while a group is being removed
+        int groupSize = numKeys - start < BATCH_GROUP_SIZE ? numKeys - start : BATCH_GROUP_SIZE;
+        for (int i = 0; i < groupSize; i++) { // hash every key and start loading its top level bucket
+            hashes[i] = table->hashFunction(keys[start + i], keyLengths[start + i], table->seed);
+            heads[i] = locateBucket(table, hashes[i]);
+            __builtin_prefetch(heads[i]);
+        }
+        for (int i = 0; i < groupSize; i++) {
+            int wasRemoved = 0;
+            *heads[i] = reformChainExcluding(&table->bucketPool, *heads[i], keys[start + i], keyLengths[start + i], hashes[i], &wasRemoved);
+            removed += wasRemoved;
+        }
+    }
+    table->numEntries -= removed;
+    return removed;
+}
+
+/**
+ * Removes many keys from the table at once, in groups whose top level buckets are prefetched together
+ * @param table The table to remove the keys from
+ * @param keys The keys to remove
+ * @param numKeys The number of keys
+ * @return The number of keys that were removed
+ */
+long removeFromTableBatch (struct HashTable *table, char *keys[], int numKeys) {
+    uint32_t keyLengths[BATCH_GROUP_SIZE];
+    long removed = 0;
+    for (int start = 0; start < numKeys; start += BATCH_GROUP_SIZE) {
+        int groupSize = numKeys - start < BATCH_GROUP_SIZE ? numKeys - start : BATCH_GROUP_SIZE;
+        for (int i = 0; i < groupSize; i++) {
+            keyLengths[i] = strlen(keys[start + i]);
+        }
+        removed += removeFromTableBatchWithLength(table, &keys[start], keyLengths, groupSize);
+    }
+    return removed;
+}
+
+/**
+ * Removes every bucket of a chain the predicate picks, relinking the chain around them as it goes
+ * @param pool The pool to give the removed buckets back to
+ * @param chain The pointer to the first bucket of the chain
+ * @param predicate The function deciding whether a bucket is removed
+ * @param context Passed on to the predicate
+ * @return The number of buckets removed
+ */
+long removeChainIf (struct NodePool *pool, struct Bucket **chain, BucketPredicate predicate, void *context) {
+    long removed = 0;
+    struct Bucket **link = chain; // holds the pointer that leads to the bucket being looked at
+    while (*link != 0) {
+        struct Bucket *current = *link;
+        if (predicate(current, context)) {
+            *link = current->chainedBucket; // point past the bucket being removed
+            releaseBucket(pool, current);
+            removed++;
+        } else {
+            link = &current->chainedBucket;
+        }
+    }
+    return removed;
+}
+
+/**
+ * Removes every key-value pair the predicate picks, in a single pass over the table. No key is hashed or searched
+ * for, each chain is compacted in place as it is walked.
+ * @param table The table to remove from
+ * @param predicate The function deciding whether a bucket is removed, it mustn't change the table
+ * @param context Passed on to the predicate
+ * @return The number of key-value pairs removed
+ */
+long removeIf (struct HashTable *table, BucketPredicate predicate, void *context) {
+    long removed = 0;
+    for (int i = table->rehashIndex; i < table->numBuckets; i++) { // the buckets before rehashIndex have already been migrated
+        removed += removeChainIf(&table->bucketPool, &table->buckets[i], predicate, context);
+    }
+    for (int i = 0; i < table->numNewBuckets; i++) {
+        removed += removeChainIf(&table->bucketPool, &table->newBuckets[i], predicate, context);
+    }
+    table->numEntries -= removed;
+    return removed;
+}
+
+/**
+ * Removes every key-value pair from the table but keeps its top level buckets, so it can be filled again without
+ * growing. Every bucket is freed with the blocks of the pool rather than one at a time. A table that was growing
+ * finishes growing first, since the larger array is the one it needed.
+ * @param table The table to clear
+ */
+void clearHashTable (struct HashTable *table) {
+    if (table->newBuckets != 0) { // keep the larger array and drop the older one
+        free(table->buckets);
+        table->buckets = table->newBuckets;
+        table->numBuckets = table->numNewBuckets;
+        table->newBuckets = 0;
+        table->numNewBuckets = 0;
+        table->rehashIndex = 0;
+    }
+    memset(table->buckets, 0, sizeof(struct Bucket *) * table->numBuckets);
+    releaseNodePool(&table->bucketPool);
+    if (table->keyPool != 0) {
+        releaseStringPool(table->keyPool);
+    }
+    table->numEntries = 0;
+}
+
+/**
+ * Finds the value stored for a key whose hash the caller already has, adding the key with a default value first if it
+ * isn't in the table. The hash must have been made by the table's hash function and seed, which change if the table
+ * rehashes itself, so it can't be kept past any call that might search the table.
+ * @param table The table to look in
+ * @param key The key to find or add
+ * @param keyLength The length of the key in bytes
+ * @param keyHash The hash of the key
+ * @param defaultValue The value to add the key with if it isn't in the table
+ * @return A pointer to the value stored for the key, valid until the key is removed or the table is destroyed, 0 if
+ *         the key isn't in the table and the table's key pool is too full to add it
+ */
+int* getOrInsertWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash, int defaultValue) {
+    migrateBuckets(table, table->rehashStep);
+    struct Bucket **bucket = locateBucket(table, keyHash);
+    int probes;
+    struct Bucket *existing = probeBucket(*bucket, key, keyLength, keyHash, &probes);
+    RECORD_PROBES(table, probes, existing != 0);
+    if (existing != 0) {
+        checkChainLength(table, probes);
+        return &existing->value;
+    }
+
+    char *owned = ownKey(table, key, keyLength, 0);
+    if (owned == 0) return 0; // the pool is full and the caller's key can't be borrowed
+    *bucket = chainValue(&table->bucketPool, *bucket, owned, keyLength, keyHash, defaultValue);
+    int *value = &(*bucket)->value; // buckets never move in memory, so this stays valid if the table grows
+    table->numEntries++;
+    COUNT_STAT(table, inserts, 1);
+    checkChainLength(table, probes + 1);
+    growIfNeeded(table);
+    return value;
+}
+
+/**
+ * Finds the value stored for a key, adding the key with a default value first if it isn't in the table. The key is
+ * hashed once and its chain walked once either way. The key doesn't need to be null terminated.
+ * @param table The table to look in
+ * @param key The key to find or add
+ * @param keyLength The length of the key in bytes
+ * @param defaultValue The value to add the key with if it isn't in the table
+ * @return A pointer to the value stored for the key, valid until the key is removed or the table is destroyed, 0 if
+ *         the key isn't in the table and the table's key pool is too full to add it
+ */
+int* getOrInsertWithLength (struct HashTable *table, char *key, uint32_t keyLength, int defaultValue) {
+    return getOrInsertWithHash(table, key, keyLength, table->hashFunction(key, keyLength, table->seed), defaultValue);
+}
+
+/**
+ * Finds the value stored for a key, adding the key with a default value first if it isn't in the table
+ * @param table The table to look in
+ * @param key The key to find or add
+ * @param defaultValue The value to add the key with if it isn't in the table
+ * @return A pointer to the value stored for the key, valid until the key is removed or the table is destroyed, 0 if
+ *         the key isn't in the table and the table's key pool is too full to add it
+ */
+int* getOrInsert (struct HashTable *table, char *key, int defaultValue) {
+    return getOrInsertWithLength(table, key, strlen(key), defaultValue);
+}
+
+/**
+ * Sets the value stored for a key, adding the key if it isn't in the table rather than chaining a duplicate. The key
+ * doesn't need to be null terminated.
+ * @param table The table to set the value in
+ * @param key The key to set the value of
+ * @param keyLength The length of the key in bytes
+ * @param value The value to store
+ */
+void upsertWithLength (struct HashTable *table, char *key, uint32_t keyLength, int value) {
+    int *stored = getOrInsertWithLength(table, key, keyLength, value);
+    if (stored != 0) {
+        *stored = value;
+    }
+}
+
+/**
+ * Sets the value stored for a key, adding the key if it isn't in the table rather than chaining a duplicate
+ * @param table The table to set the value in
+ * @param key The key to set the value of
+ * @param value The value to store
+ */
+void upsert (struct HashTable *table, char *key, int value) {
+    upsertWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Adds to the value stored for a key, a key that isn't in the table is added with a value of delta. The key doesn't
+ * need to be null terminated.
+ * @param table The table to update
+ * @param key The key to add to the value of
+ * @param keyLength The length of the key in bytes
+ * @param delta The amount to add
+ * @return The value stored for the key after adding, 0 if the key isn't in the table and the table's key pool is too
+ *         full to add it
+ */
+int incrementWithLength (struct HashTable *table, char *key, uint32_t keyLength, int delta) {
+    int *value = getOrInsertWithLength(table, key, keyLength, 0);
+    if (value == 0) return 0;
+    *value += delta;
+    return *value;
+}
+
+/**
+ * Adds to the value stored for a key, a key that isn't in the table is added with a value of delta
+ * @param table The table to update
+ * @param key The key to add to the value of
+ * @param delta The amount to add
+ * @return The value stored for the key after adding, 0 if the key isn't in the table and the table's key pool is too
+ *         full to add it
+ */
+int increment (struct HashTable *table, char *key, int delta) {
+    return incrementWithLength(table, key, strlen(key), delta);
+}
+
+/**
+ * Prints the key-value pair in the bucket provided
+ * @param bucket The bucket to print
+ */
+void printBucket(struct Bucket *bucket) {
+    while (bucket != 0) { // Print the chained buckets too, most recently added first
+        printf("%.*s:%d ", (int) bucket->keyLength, bucketKey(bucket), bucket->value);
+        bucket = bucket->chainedBucket;
+    }
+}
+
+/**
+ * OutputBuffer struct, collects text in memory so it can be written out with a single call
+ */
+struct OutputBuffer {
+    char *data; // holds the text
+    size_t length; // holds the number of bytes of text
+    size_t capacity; // holds the number of bytes there is room for
+};
+
+/**
+ * Makes room in a buffer for more text, doubling its size as needed
+ * @param buffer The buffer to make room in
+ * @param needed The number of bytes about to be appended
+ */
+void reserveOutput (struct OutputBuffer *buffer, size_t needed) {
+    if (buffer->length + needed <= buffer->capacity) return;
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : 4096;
+    while (buffer->length + needed > capacity) {
+        capacity *= 2;
+    }
+    buffer->data = realloc(buffer->data, capacity);
+    buffer->capacity = capacity;
+}
+
+/**
+ * Appends bytes to a buffer
+ * @param buffer The buffer to append to
+ * @param bytes The bytes to append
+ * @param length The number of bytes
+ */
+void appendOutput (struct OutputBuffer *buffer, const char *bytes, size_t length) {
+    reserveOutput(buffer, length);
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+/**
+ * Appends an integer to a buffer in decimal, without going through printf
+ * @param buffer The buffer to append to
+ * @param number The integer to append
+ */
+void appendIntOutput (struct OutputBuffer *buffer, long number) {
+    char digits[24];
+    int start = sizeof(digits);
+    unsigned long magnitude = number < 0 ? 0ul - (unsigned long) number : (unsigned long) number;
+    do { // fill the digits in from the end
+        digits[--start] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (number < 0) {
+        digits[--start] = '-';
+    }
+    appendOutput(buffer, &digits[start], sizeof(digits) - start);
+}
+
+/**
+ * Appends the key-value pairs of a bucket chain to a buffer, the same way printBucket prints them
+ * @param buffer The buffer to append to
+ * @param bucket The bucket chain to append
+ */
+void appendBucketOutput (struct OutputBuffer *buffer, struct Bucket *bucket) {
+    while (bucket != 0) {
+        appendOutput(buffer, bucketKey(bucket), bucket->keyLength);
+        appendOutput(buffer, ":", 1);
+        appendIntOutput(buffer, bucket->value);
+        appendOutput(buffer, " ", 1);
+        bucket = bucket->chainedBucket;
+    }
+}
+
+/**
+ * Prints the entire table provided. The text is built up in memory and written with a single fwrite rather than a
+ * printf per key. While the table is growing the buckets not yet migrated are printed first, then every bucket of the
+ * array being grown into, labelled "new" so their indices can't be mistaken for the old array's.
+ * @param table
+ */
+void printTable (struct HashTable *table) {
+    struct OutputBuffer buffer = {0, 0, 0};
+    for (int i = table->rehashIndex; i < table->numBuckets; i++) { // Loop through all top level buckets and print them and their chains
+        appendOutput(&buffer, "\n[", 2);
+        appendIntOutput(&buffer, i);
+        appendOutput(&buffer, "] ", 2);
+        appendBucketOutput(&buffer, table->buckets[i]);
+    }
+    for (int i = 0; i < table->numNewBuckets; i++) { // Print the whole array being grown into if the table is growing
+        appendOutput(&buffer, "\n[new ", 6);
+        appendIntOutput(&buffer, i);
+        appendOutput(&buffer, "] ", 2);
+        appendBucketOutput(&buffer, table->newBuckets[i]);
+    }
+    appendOutput(&buffer, "\n", 1);
+    fwrite(buffer.data, 1, buffer.length, stdout);
+    free(buffer.data);
+}
+
+/**
+ * Starts iterating over every bucket of a table. The table mustn't be added to or removed from until iterating is
+ * done.
+ * @param table The table to iterate over
+ * @param iterator The iterator to start
+ */
+void initHashTableIterator (struct HashTable *table, struct HashTableIterator *iterator) {
+    iterator->block = table->bucketPool.arena.blocks;
+    iterator->offset = 0;
+    iterator->bucketSize = table->bucketPool.nodeSize;
+}
+
+/**
+ * Gets the next bucket of the table being iterated over. Buckets come in the order they were allocated, which is the
+ * order their keys were added unless removing a key has let its bucket be reused.
+ * @param iterator The iterator
+ * @return The next bucket, 0 once every bucket has been visited
+ */
+struct Bucket* nextTableBucket (struct HashTableIterator *iterator) {
+    while (iterator->block != 0) {
+        while (iterator->offset < iterator->block->used) {
+            struct Bucket *bucket = (struct Bucket *) (iterator->block->data + iterator->offset);
+            iterator->offset += iterator->bucketSize;
+            if (bucket->keyLength != FREED_KEY_LENGTH) {
+                return bucket;
+            }
+        }
+        iterator->block = iterator->block->next;
+        iterator->offset = 0;
+    }
+    return 0;
+}
+
+/**
+ * Writes every key-value pair of the table to a stream, one "key:value" per line in the order the iterator gives
+ * them. The whole dump is built up in memory and written with a single fwrite.
+ * @param table The table to dump
+ * @param stream The stream to write to
+ * @return 0 if the dump was written, -1 otherwise
+ */
+int dumpTable (struct HashTable *table, FILE *stream) {
+    struct OutputBuffer buffer = {0, 0, 0};
+    struct HashTableIterator iterator;
+    initHashTableIterator(table, &iterator);
+    for (struct Bucket *bucket = nextTableBucket(&iterator); bucket != 0; bucket = nextTableBucket(&iterator)) {
+        appendOutput(&buffer, bucketKey(bucket), bucket->keyLength);
+        appendOutput(&buffer, ":", 1);
+        appendIntOutput(&buffer, bucket->value);
+        appendOutput(&buffer, "\n", 1);
+    }
+    size_t written = buffer.length > 0 ? fwrite(buffer.data, 1, buffer.length, stream) : 0;
+    free(buffer.data);
+    return written == buffer.length ? 0 : -1;
+}
+
+#ifdef HASHTABLE_STATS
+/**
+ * Counts a lookup of the table, only built with HASHTABLE_STATS
+ * @param table The table that was searched
+ * @param probes The number of buckets compared
+ * @param found Whether the key was found
+ */
+void recordProbes (struct HashTable *table, int probes, int found) {
+    if (found) {
+        table->counters.hits++;
+    } else {
+        table->counters.misses++;
+    }
+    table->counters.probes += probes;
+    if (probes > table->counters.maxProbes) {
+        table->counters.maxProbes = probes;
+    }
+}
+#endif
+
+/**
+ * Adds the chain lengths of an array of top level buckets to a histogram
+ * @param stats The stats to add to
+ * @param buckets The array of buckets
+ * @param start The index of the first bucket to count
+ * @param end One past the index of the last bucket to count
+ */
+void countChainLengths (struct HashTableStats *stats, struct Bucket **buckets, int start, int end) {
+    for (int i = start; i < end; i++) {
+        int length = 0;
+        for (struct Bucket *bucket = buckets[i]; bucket != 0; bucket = bucket->chainedBucket) {
+            length++;
+        }
+        stats->chainLengths[length < STATS_HISTOGRAM_SIZE ? length : STATS_HISTOGRAM_SIZE - 1]++;
+        if (length > stats->maxChainLength) {
+            stats->maxChainLength = length;
+        }
+    }
+}
+
+/**
+ * Fills in the stats of a table: its load factor, a histogram of its chain lengths and how much memory it uses, along
+ * with its counters when the library is built with HASHTABLE_STATS. Every chain is walked, so this takes as long as
+ * iterating over the table.
+ * @param table The table to get the stats of
+ * @param stats The stats to fill in
+ */
+void getHashTableStats (struct HashTable *table, struct HashTableStats *stats) {
+    memset(stats, 0, sizeof(struct HashTableStats));
+    stats->numEntries = table->numEntries;
+    stats->numBuckets = table->numBuckets - table->rehashIndex + table->numNewBuckets; // the migrated buckets have moved into the new array
+    stats->loadFactor = getLoadFactor(table);
+    countChainLengths(stats, table->buckets, table->rehashIndex, table->numBuckets);
+    if (table->newBuckets != 0) {
+        countChainLengths(stats, table->newBuckets, 0, table->numNewBuckets);
+    }
+
+    stats->bytesAllocated = sizeof(struct HashTable) + sizeof(struct Bucket *) * ((size_t) table->numBuckets + table->numNewBuckets);
+    for (struct ArenaBlock *block = table->bucketPool.arena.blocks; block != 0; block = block->next) {
+        stats->bytesAllocated += sizeof(struct ArenaBlock) + block->size;
+    }
+    if (table->keyPool != 0) {
+        stats->bytesAllocated += sizeof(struct StringPool) + table->keyPool->bytesAllocated;
+    }
+#ifdef HASHTABLE_STATS
+    stats->countersEnabled = 1;
+    stats->counters = table->counters;
+#endif
+}
+
+/**
+ * Function to read an array into the table, counting how many times each string appears.
+ * @param table The hashtable to add to
+ * @param names The array of strings to add
+ * @param length The length of the array
+ */
+void readIntoTable (struct HashTable *table, char *names[], int length) {
+    for (int i = 0; i < length; i++) {
+        if (names[i][0] != '\0') {
+            increment(table, names[i], 1);
+        }
+    }
+}
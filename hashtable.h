@@ -0,0 +1,194 @@
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "hash.h"
+#include "stringpool.h"
+
+#define INLINE_KEY_SIZE 24 // keys shorter than this are copied into their bucket rather than pointed to
+#ifdef HASHTABLE_STATS
+#define COUNT_STAT(table, counter, amount) ((table)->counters.counter += (amount)) // adds to a counter of the table
+#define RECORD_PROBES(table, probes, found) recordProbes((table), (probes), (found)) // counts a lookup of the table
+#else
+#define COUNT_STAT(table, counter, amount) ((void) 0)
+#define RECORD_PROBES(table, probes, found) ((void) 0)
+#endif
+
+#define FREED_KEY_LENGTH UINT32_MAX // the key length of a bucket that has been given back to the pool
+#define STATS_HISTOGRAM_SIZE 16 // the number of chain lengths getHashTableStats counts separately
+#define BATCH_GROUP_SIZE 16 // the number of keys a batched search has in flight at once
+#define CHAIN_LOAD_MULTIPLE 16 // how many times the load factor a chain must be before it counts as an attack
+#define MAX_RESEEDS 2 // the number of times a table rehashes itself after finding a long chain
+
+/**
+ * HashTableOptions struct, holds the settings used to construct a hashtable and control how it grows
+ */
+struct HashTableOptions {
+    int numBuckets; // holds the number of top level buckets the table starts with
+    double maxLoadFactor; // holds the entries per bucket at which the table starts growing, 0 to never grow
+    int rehashStep; // holds the number of buckets migrated on each add, search or remove while the table is growing
+    HashFunction hashFunction; // holds the function used to hash keys, wyHash unless set
+    uint64_t seed; // holds the seed passed to the hash function, random unless set
+    int maxChainLength; // holds the chain length a lookup can walk before the table rehashes with a new seed, 0 to never rehash
+    int powerOfTwoBuckets; // holds whether to round the number of buckets up to a power of two so they can be masked
+    int internKeys; // holds whether the table interns every key it keeps in a pool of its own, so callers needn't keep them and equal keys share a handle
+};
+
+/**
+ * HashTableCounters struct, counts what a table does. The counters are only kept when the library is built with
+ * HASHTABLE_STATS defined, so a normal build pays nothing for them.
+ */
+struct HashTableCounters {
+    long inserts; // holds the number of keys added
+    long hits; // holds the number of lookups that found their key
+    long misses; // holds the number of lookups that didn't
+    long probes; // holds the total number of buckets compared by lookups
+    long maxProbes; // holds the most buckets compared by a single lookup
+    long resizes; // holds the number of times the table started growing
+    long reseeds; // holds the number of times a long chain made the table rehash with a new seed
+};
+
+/**
+ * HashTableStats struct, a view of a table's shape for exporting to a metrics system
+ */
+struct HashTableStats {
+    long numEntries; // holds the number of key-value pairs stored in the table
+    int numBuckets; // holds the number of top level buckets, counting both arrays while growing
+    double loadFactor; // holds the load factor
+    long chainLengths[STATS_HISTOGRAM_SIZE]; // holds the number of top level buckets with each chain length, the last counts every longer chain too
+    int maxChainLength; // holds the length of the longest chain
+    size_t bytesAllocated; // holds the bytes allocated for the table, its buckets and its pool
+    int countersEnabled; // holds whether the library was built with HASHTABLE_STATS, counters are all 0 otherwise
+    struct HashTableCounters counters; // holds the table's counters
+};
+
+/**
+ * HashTable struct, stores an array of pointers to the top level buckets and keeps a track of the number of buckets.
+ * While the table is growing it also holds the larger array the buckets are being migrated into, buckets below
+ * rehashIndex have already been moved and every key lives in exactly one of the two arrays.
+ */
+struct HashTable {
+    int numBuckets; // holds the number of buckets in the table
+    struct Bucket **buckets; // holds a pointer to an array of pointers to buckets, 0 for an empty bucket
+    int numNewBuckets; // holds the number of buckets in the array being grown into, 0 when not growing
+    struct Bucket **newBuckets; // holds the array the buckets are being migrated into, 0 when not growing
+    int rehashIndex; // holds the index of the next bucket in buckets to migrate
+    long numEntries; // holds the number of key-value pairs stored in the table
+    double maxLoadFactor; // holds the load factor at which the table starts growing, 0 to never grow
+    int rehashStep; // holds the number of buckets migrated per operation while growing
+    HashFunction hashFunction; // holds the function used to hash keys
+    uint64_t seed; // holds the seed passed to the hash function
+    int maxChainLength; // holds the chain length a lookup can walk before the table rehashes with a new seed, 0 to never rehash
+    int numReseeds; // holds the number of times the table has rehashed with a new seed, at most MAX_RESEEDS
+    int powerOfTwoBuckets; // holds whether the number of buckets is a power of two, indexed with a mask
+    struct NodePool bucketPool; // holds the pool every bucket of the table is allocated from
+    struct StringPool *keyPool; // holds the pool every key is interned in, long keys are read from it, 0 unless the table interns keys
+#ifdef HASHTABLE_STATS
+    struct HashTableCounters counters; // holds what the table has done since it was constructed
+#endif
+};
+
+/**
+ * Bucket struct, stores a key-value pair and a pointer to a chained bucket
+ */
+struct Bucket {
+    struct Bucket *chainedBucket; // holds a pointer to a bucket chained to this bucket, 0 at the end of the chain
+    uint64_t hash; // holds the hash of the key, compared before the key itself and reused when resizing
+    uint32_t keyLength; // holds the length of the key in bytes, which also says where the key is kept
+    int value; // holds the value associated with the key
+    union {
+        char bytes[INLINE_KEY_SIZE]; // holds a copy of a key shorter than INLINE_KEY_SIZE, null terminated
+        char *pointer; // holds a longer key, not necessarily null terminated
+    } key;
+};
+
+/**
+ * Gets the key a bucket holds, wherever it is kept
+ * @param bucket The bucket to get the key of
+ * @return The key, keyLength bytes long
+ */
+static inline char* bucketKey (struct Bucket *bucket) {
+    return bucket->keyLength < INLINE_KEY_SIZE ? bucket->key.bytes : bucket->key.pointer;
+}
+
+/**
+ * A function that decides whether a bucket should be removed by removeIf
+ */
+typedef int (*BucketPredicate)(struct Bucket *bucket, void *context);
+
+/**
+ * HashTableIterator struct, walks every bucket of a table straight through the blocks of its pool rather than through
+ * the top level buckets and their chains, so empty buckets cost nothing and buckets are read in the order they sit in
+ * memory
+ */
+struct HashTableIterator {
+    struct ArenaBlock *block; // holds the block being walked, 0 once every block has been
+    size_t offset; // holds the offset of the next bucket in the block
+    size_t bucketSize; // holds the size of each bucket in the pool
+};
+
+struct Bucket** allocateBuckets (int numBuckets);
+#ifdef HASHTABLE_STATS
+void recordProbes (struct HashTable *table, int probes, int found);
+#endif
+struct HashTableOptions defaultHashTableOptions ();
+struct HashTable* constructHashTableWithOptions (const struct HashTableOptions *options);
+struct HashTable* constructHashTable (int numBuckets);
+void destroyHashTable (struct HashTable *table);
+int bucketIndex (struct HashTable *table, uint64_t keyHash, int numBuckets);
+struct Bucket** locateBucket (struct HashTable *table, uint64_t keyHash);
+void migrateBuckets (struct HashTable *table, int count);
+void growIfNeeded (struct HashTable *table);
+double getLoadFactor (struct HashTable *table);
+int canReseed (struct HashTable *table);
+void reseedHashTable (struct HashTable *table);
+void checkChainLength (struct HashTable *table, int probes);
+int boundedChainLength (struct HashTable *table, struct Bucket *bucket);
+void setBucketKey (struct Bucket *bucket, char *key, uint32_t keyLength);
+char* ownKey (struct HashTable *table, char *key, uint32_t keyLength, uint32_t *handle);
+uint32_t getKeyHandle (struct HashTable *table, struct Bucket *bucket);
+struct Bucket* chainValue(struct NodePool *pool, struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash, int value);
+void addToTableWithLength (struct HashTable *table, char *key, uint32_t keyLength, int value);
+void addToTable (struct HashTable *table, char *key, int value);
+uint32_t addToTableInternedWithLength (struct HashTable *table, char *key, uint32_t keyLength, int value);
+uint32_t addToTableInterned (struct HashTable *table, char *key, int value);
+uint32_t addToTableWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash, int value);
+int bucketHasKey (struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash);
+struct Bucket* probeBucket (struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash, int *probes);
+struct Bucket* searchBucket (struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash);
+struct Bucket* searchTableWithLength (struct HashTable *table, char *key, uint32_t keyLength);
+struct Bucket* searchTable (struct HashTable *table, char *key);
+struct Bucket* searchTableWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash);
+void searchTableGroup (struct HashTable *table, char *keys[], const uint32_t keyLengths[], int groupSize, struct Bucket *results[]);
+void searchTableBatchWithLength (struct HashTable *table, char *keys[], const uint32_t keyLengths[], int numKeys, struct Bucket *results[]);
+void searchTableBatch (struct HashTable *table, char *keys[], int numKeys, struct Bucket *results[]);
+void printKeyValue (struct HashTable *table, char *key);
+void releaseBucket (struct NodePool *pool, struct Bucket *bucket);
+struct Bucket* reformChainExcluding(struct NodePool *pool, struct Bucket *bucket, char *key, uint32_t keyLength, uint64_t keyHash, int *removed);
+void removeFromTableWithLength (struct HashTable *table, char *key, uint32_t keyLength);
+void removeFromTable (struct HashTable *table, char *key);
+void removeFromTableWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash);
+long removeFromTableBatchWithLength (struct HashTable *table, char *keys[], const uint32_t keyLengths[], int numKeys);
+long removeFromTableBatch (struct HashTable *table, char *keys[], int numKeys);
+long removeChainIf (struct NodePool *pool, struct Bucket **chain, BucketPredicate predicate, void *context);
+long removeIf (struct HashTable *table, BucketPredicate predicate, void *context);
+void clearHashTable (struct HashTable *table);
+int* getOrInsertWithHash (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash, int defaultValue);
+int* getOrInsertWithLength (struct HashTable *table, char *key, uint32_t keyLength, int defaultValue);
+int* getOrInsert (struct HashTable *table, char *key, int defaultValue);
+void upsertWithLength (struct HashTable *table, char *key, uint32_t keyLength, int value);
+void upsert (struct HashTable *table, char *key, int value);
+int incrementWithLength (struct HashTable *table, char *key, uint32_t keyLength, int delta);
+int increment (struct HashTable *table, char *key, int delta);
+void printBucket(struct Bucket *bucket);
+void printTable (struct HashTable *table);
+void initHashTableIterator (struct HashTable *table, struct HashTableIterator *iterator);
+struct Bucket* nextTableBucket (struct HashTableIterator *iterator);
+int dumpTable (struct HashTable *table, FILE *stream);
+void getHashTableStats (struct HashTable *table, struct HashTableStats *stats);
+void readIntoTable (struct HashTable *table, char *names[], int length);
+
+#endif // HASHTABLE_H
@@ -0,0 +1,414 @@
+#define _GNU_SOURCE // for memrchr
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "loader.h"
+
+#define STREAM_FIELD_START 0 // at the start of a field
+#define STREAM_UNQUOTED 1 // within a field that isn't quoted
+#define STREAM_QUOTED 2 // within a quoted field
+#define STREAM_QUOTE_SEEN 3 // just past a quote within a quoted field, which either closes it or is doubled
+#define STREAM_AFTER_QUOTE 4 // past the closing quote of a field, before its separator
+
+
+/**
+ * A function to map a whole file into memory so it can be read without copying it
+ * @param path The path of the file to map
+ * @param file The MappedFile struct to fill in
+ * @return 0 if the file was mapped, -1 if it couldn't be opened or mapped
+ */
+int mapFile (const char *path, struct MappedFile *file) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    file->size = info.st_size;
+    file->data = 0;
+    if (file->size > 0) { // mmap can't map an empty file
+        void *data = mmap(0, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0); // writable so fields can be unescaped in place
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(data, file->size, MADV_SEQUENTIAL); // let the kernel read ahead aggressively
+        file->data = data;
+    }
+    close(fd); // the mapping stays valid after the file is closed
+    return 0;
+}
+
+/**
+ * A function to unmap a file mapped by mapFile. Any keys pointing into it must no longer be used.
+ * @param file The file to unmap
+ */
+void unmapFile (struct MappedFile *file) {
+    if (file->data != 0) {
+        munmap(file->data, file->size);
+    }
+    file->data = 0;
+    file->size = 0;
+}
+
+/**
+ * A function to find the next field of comma or newline separated values, where a field may be wrapped in double
+ * quotes. Quoted fields can hold commas and newlines, and a doubled quote inside one stands for a single quote. The
+ * field is left where it is, only a quoted field with doubled quotes in it is rewritten in place to unescape it.
+ * Separators are found with memchr so long runs are scanned a vector at a time.
+ * @param cursor The position to start from, moved past the field and its separator
+ * @param end The end of the data
+ * @param field Set to the first byte of the field
+ * @param length Set to the length of the field in bytes
+ * @return 1 if a field was found, 0 if there's no data left
+ */
+int nextCsvField (char **cursor, char *end, char **field, uint32_t *length) {
+    char *p = *cursor;
+    if (p >= end) return 0;
+
+    if (*p == '"') { // a quoted field runs to the next quote that isn't doubled
+        char *start = p + 1;
+        char *out = start; // where unescaped bytes are written, only behind p once a doubled quote has been seen
+        p = start;
+        for (;;) {
+            char *quote = memchr(p, '"', end - p);
+            if (quote == 0) quote = end; // an unterminated quote runs to the end of the data
+            if (out != p) memmove(out, p, quote - p);
+            out += quote - p;
+            p = quote;
+            if (p + 1 < end && p[1] == '"') { // a doubled quote stands for one quote
+                *out++ = '"';
+                p += 2;
+                continue;
+            }
+            break;
+        }
+        *field = start;
+        *length = out - start;
+        if (p < end) p++; // step over the closing quote
+        while (p < end && *p != ',' && *p != '\n') p++; // skip anything between the quote and the separator
+    } else {
+        char *comma = memchr(p, ',', end - p);
+        char *stop = comma != 0 ? comma : end;
+        char *newline = memchr(p, '\n', stop - p);
+        if (newline != 0) stop = newline;
+        *field = p;
+        *length = stop - p;
+        if (*length > 0 && p[*length - 1] == '\r') (*length)--; // don't keep the carriage return of a CRLF line ending
+        p = stop;
+    }
+
+    if (p < end) p++; // step over the separator
+    *cursor = p;
+    return 1;
+}
+
+/**
+ * A function to count every field of a block of comma separated values into a table. The keys point straight into
+ * the data, so it must stay mapped for as long as the table is used.
+ * @param table The table to count the keys into
+ * @param data The data to read, usually a MappedFile
+ * @param size The size of the data in bytes
+ * @return The number of keys counted, empty fields are skipped, -1 if the table's key pool filled up, in which case
+ *         the keys before it have still been counted
+ */
+long loadKeysIntoTable (struct HashTable *table, char *data, size_t size) {
+    char *cursor = data;
+    char *end = data + size;
+    char *field;
+    uint32_t length;
+    long numKeys = 0;
+
+    while (nextCsvField(&cursor, end, &field, &length)) {
+        if (length > 0) {
+            int *count = getOrInsertWithLength(table, field, length, 0);
+            if (count == 0) return -1; // the key pool is full
+            (*count)++;
+            numKeys++;
+        }
+    }
+    return numKeys;
+}
+
+/**
+ * A function to set up a loader that counts keys into a table as chunks of data are fed to it. The chunks are reused
+ * once fed, so the table must copy the keys it keeps.
+ * @param loader The loader to set up
+ * @param table The table to count the keys into
+ * @return 0 if the loader was set up, -1 if the table doesn't intern its keys
+ */
+int initStreamLoader (struct StreamLoader *loader, struct HashTable *table) {
+    if (table->keyPool == 0) return -1; // its keys would point into chunks that are about to be overwritten
+    loader->table = table;
+    loader->pending = 0;
+    loader->pendingLength = 0;
+    loader->pendingCapacity = 0;
+    loader->state = STREAM_FIELD_START;
+    loader->numKeys = 0;
+    return 0;
+}
+
+/**
+ * Adds bytes onto the end of the data a loader is holding back
+ * @param loader The loader
+ * @param data The bytes to add
+ * @param length The number of bytes
+ * @return 0 if the bytes were held back, -1 if there wasn't the memory, in which case what was held back before is kept
+ */
+int holdBack (struct StreamLoader *loader, const char *data, size_t length) {
+    if (length == 0) return 0;
+    if (loader->pendingLength + length > loader->pendingCapacity) {
+        size_t capacity = loader->pendingCapacity > 0 ? loader->pendingCapacity : 256;
+        while (capacity < loader->pendingLength + length) {
+            capacity *= 2;
+        }
+        char *pending = realloc(loader->pending, capacity);
+        if (pending == 0) return -1;
+        loader->pending = pending;
+        loader->pendingCapacity = capacity;
+    }
+    memcpy(loader->pending + loader->pendingLength, data, length);
+    loader->pendingLength += length;
+    return 0;
+}
+
+/**
+ * Scans a chunk for the end of the last field that is complete within it, following fields and quotes the same way
+ * nextCsvField does. A chunk without quotes, read outside of a quoted field, only needs its last separator found.
+ * @param loader The loader, its state is moved on to the end of the chunk
+ * @param chunk The chunk
+ * @param length The length of the chunk in bytes
+ * @return The number of bytes up to and including the last separator that ends a field, 0 if there isn't one
+ */
+size_t completeFieldsLength (struct StreamLoader *loader, const char *chunk, size_t length) {
+    int state = loader->state;
+    if (length == 0 || chunk == 0) return 0; // nothing to scan, which also tells the compiler the searches below get a real chunk
+    if (state != STREAM_QUOTED && state != STREAM_QUOTE_SEEN && memchr(chunk, '"', length) == 0) {
+        const char *comma = memrchr(chunk, ',', length);
+        const char *newline = memrchr(chunk, '\n', length);
+        const char *separator = comma == 0 || (newline != 0 && newline > comma) ? newline : comma;
+        if (separator == 0) {
+            loader->state = state == STREAM_FIELD_START ? STREAM_UNQUOTED : state;
+            return 0;
+        }
+        size_t complete = separator - chunk + 1;
+        loader->state = complete == length ? STREAM_FIELD_START : STREAM_UNQUOTED;
+        return complete;
+    }
+
+    size_t complete = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = chunk[i];
+        int separator = c == ',' || c == '\n';
+        switch (state) {
+            case STREAM_FIELD_START:
+                state = c == '"' ? STREAM_QUOTED : separator ? STREAM_FIELD_START : STREAM_UNQUOTED;
+                break;
+            case STREAM_QUOTED:
+                if (c == '"') state = STREAM_QUOTE_SEEN;
+                separator = 0; // separators within quotes are part of the field
+                break;
+            case STREAM_QUOTE_SEEN:
+                state = c == '"' ? STREAM_QUOTED : separator ? STREAM_FIELD_START : STREAM_AFTER_QUOTE;
+                break;
+            default: // within an unquoted field or after a closing quote, only a separator matters
+                if (separator) state = STREAM_FIELD_START;
+                break;
+        }
+        if (separator) {
+            complete = i + 1;
+        }
+    }
+    loader->state = state;
+    return complete;
+}
+
+/**
+ * Counts every field of a block of data into a loader's table, adding them to the loader's count
+ * @param loader The loader the data was fed to
+ * @param data The data, ending at the end of a field
+ * @param size The size of the data in bytes
+ * @return 0 if every field was counted, -1 if the table's key pool filled up
+ */
+int countLoaderKeys (struct StreamLoader *loader, char *data, size_t size) {
+    long counted = loadKeysIntoTable(loader->table, data, size);
+    if (counted < 0) return -1;
+    loader->numKeys += counted;
+    return 0;
+}
+
+/**
+ * Counts every field of a chunk that ends within it into the loader's table, holding back the start of a field that
+ * runs past the end of the chunk. Fields are read in place, so the chunk may be rewritten, and can be reused as soon
+ * as this returns.
+ * @param loader The loader to feed
+ * @param chunk The chunk of data
+ * @param length The length of the chunk in bytes
+ * @return 0 if the chunk was taken, -1 if there wasn't the memory to hold back a field or the table's key pool filled
+ *         up, the loader can't be fed again
+ */
+int feedStreamLoader (struct StreamLoader *loader, char *chunk, size_t length) {
+    size_t complete = completeFieldsLength(loader, chunk, length);
+    if (complete == 0) {
+        return holdBack(loader, chunk, length); // the field carries on past this chunk
+    }
+
+    if (loader->pendingLength > 0) { // finish the field held back from earlier chunks, along with the rest
+        if (holdBack(loader, chunk, complete) != 0) return -1;
+        size_t pendingLength = loader->pendingLength;
+        loader->pendingLength = 0; // so finishing the loader doesn't count the fields again if this fails
+        if (countLoaderKeys(loader, loader->pending, pendingLength) != 0) return -1;
+    } else if (countLoaderKeys(loader, chunk, complete) != 0) {
+        return -1;
+    }
+    return holdBack(loader, chunk + complete, length - complete);
+}
+
+/**
+ * Counts whatever a loader held back as the last field, then frees what the loader allocated
+ * @param loader The loader to finish
+ * @return The number of keys counted since the loader was set up, empty fields are skipped, -1 if the table's key pool
+ *         filled up counting the last field
+ */
+long finishStreamLoader (struct StreamLoader *loader) {
+    int counted = loader->pendingLength > 0 ? countLoaderKeys(loader, loader->pending, loader->pendingLength) : 0;
+    free(loader->pending);
+    loader->pending = 0;
+    loader->pendingLength = 0;
+    loader->pendingCapacity = 0;
+    return counted != 0 ? -1 : loader->numKeys;
+}
+
+/**
+ * StreamBuffers struct, the two buffers a reader thread fills while the other is being parsed
+ */
+struct StreamBuffers {
+    int fd; // holds the file descriptor being read
+    char *data[2]; // holds the two buffers, STREAM_CHUNK_SIZE bytes each
+    size_t length[2]; // holds the number of bytes read into each buffer
+    int full[2]; // holds whether each buffer is waiting to be parsed
+    int failed; // holds whether a read failed
+    int stopped; // holds whether the parser has given up, so the reader stops too
+    pthread_mutex_t lock; // holds the lock guarding length, full and failed
+    pthread_cond_t changed; // holds the condition signalled whenever a buffer is filled or emptied
+};
+
+/**
+ * The reader thread, fills the buffers in turn until the end of the data, a full buffer of length 0 marks the end
+ * @param argument The StreamBuffers
+ * @return 0
+ */
+void* readStreamBuffers (void *argument) {
+    struct StreamBuffers *buffers = argument;
+    for (int i = 0; ; i ^= 1) {
+        pthread_mutex_lock(&buffers->lock);
+        while (buffers->full[i] && !buffers->stopped) { // wait for the parser to finish with this buffer
+            pthread_cond_wait(&buffers->changed, &buffers->lock);
+        }
+        int stopped = buffers->stopped;
+        pthread_mutex_unlock(&buffers->lock);
+        if (stopped) return 0;
+
+        ssize_t bytesRead;
+        do { // a pipe or socket hands back whatever has arrived, which is parsed straight away rather than waited on
+            bytesRead = read(buffers->fd, buffers->data[i], STREAM_CHUNK_SIZE);
+        } while (bytesRead < 0 && errno == EINTR);
+
+        pthread_mutex_lock(&buffers->lock);
+        buffers->length[i] = bytesRead > 0 ? bytesRead : 0;
+        buffers->full[i] = 1;
+        if (bytesRead < 0) buffers->failed = 1; // never cleared, the parser may have failed first
+        pthread_cond_broadcast(&buffers->changed);
+        pthread_mutex_unlock(&buffers->lock);
+        if (bytesRead <= 0) return 0;
+    }
+}
+
+/**
+ * A function to count every field of comma separated values read from a file descriptor into a table, such as a pipe
+ * or socket. A thread reads the next chunk into one buffer while the last one is parsed from the other, so parsing
+ * overlaps the reads, and only the two buffers and the longest field are ever held in memory.
+ * @param table The table to count the keys into, it must intern its keys
+ * @param fd The file descriptor to read until the end of its data
+ * @return The number of keys counted, empty fields are skipped, -1 if the table doesn't intern its keys, a read
+ *         failed, there wasn't the memory to hold back a field or the table's key pool filled up, in which case the
+ *         keys read before the failure have still been counted
+ */
+long streamKeysIntoTable (struct HashTable *table, int fd) {
+    struct StreamLoader loader;
+    if (initStreamLoader(&loader, table) != 0) return -1;
+
+    struct StreamBuffers buffers;
+    buffers.fd = fd;
+    for (int i = 0; i < 2; i++) {
+        buffers.data[i] = malloc(STREAM_CHUNK_SIZE);
+        buffers.length[i] = 0;
+        buffers.full[i] = 0;
+    }
+    if (buffers.data[0] == 0 || buffers.data[1] == 0) {
+        free(buffers.data[0]);
+        free(buffers.data[1]);
+        finishStreamLoader(&loader);
+        return -1;
+    }
+    buffers.failed = 0;
+    buffers.stopped = 0;
+    pthread_mutex_init(&buffers.lock, 0);
+    pthread_cond_init(&buffers.changed, 0);
+
+    pthread_t reader;
+    if (pthread_create(&reader, 0, readStreamBuffers, &buffers) == 0) {
+        for (int i = 0; ; i ^= 1) {
+            pthread_mutex_lock(&buffers.lock);
+            while (!buffers.full[i]) { // wait for the reader to fill this buffer
+                pthread_cond_wait(&buffers.changed, &buffers.lock);
+            }
+            size_t length = buffers.length[i];
+            pthread_mutex_unlock(&buffers.lock);
+            if (length == 0) break; // the end of the data
+
+            int fed = feedStreamLoader(&loader, buffers.data[i], length);
+            pthread_mutex_lock(&buffers.lock);
+            buffers.full[i] = 0;
+            if (fed != 0) {
+                buffers.failed = 1;
+                buffers.stopped = 1; // the reader stops once its current read returns
+            }
+            pthread_cond_broadcast(&buffers.changed);
+            pthread_mutex_unlock(&buffers.lock);
+            if (fed != 0) break;
+        }
+        pthread_join(reader, 0);
+    } else { // read and parse in turn from the one buffer, without the overlap
+        for (;;) {
+            ssize_t bytesRead;
+            do {
+                bytesRead = read(fd, buffers.data[0], STREAM_CHUNK_SIZE);
+            } while (bytesRead < 0 && errno == EINTR);
+            if (bytesRead <= 0) {
+                buffers.failed = bytesRead < 0;
+                break;
+            }
+            if (feedStreamLoader(&loader, buffers.data[0], bytesRead) != 0) {
+                buffers.failed = 1;
+                break;
+            }
+        }
+    }
+
+    long numKeys = finishStreamLoader(&loader);
+    pthread_cond_destroy(&buffers.changed);
+    pthread_mutex_destroy(&buffers.lock);
+    free(buffers.data[0]);
+    free(buffers.data[1]);
+    return buffers.failed || numKeys < 0 ? -1 : numKeys;
+}
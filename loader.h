@@ -0,0 +1,44 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hashtable.h"
+
+#define STREAM_CHUNK_SIZE 65536 // the size of each of the two buffers streamKeysIntoTable reads into
+
+
+/**
+ * MappedFile struct, holds a file mapped into memory. The mapping is private, so tokenizing it in place never
+ * changes the file on disk.
+ */
+struct MappedFile {
+    char *data; // holds the first byte of the mapping, 0 for an empty file
+    size_t size; // holds the size of the file in bytes
+};
+
+int mapFile (const char *path, struct MappedFile *file);
+void unmapFile (struct MappedFile *file);
+/**
+ * StreamLoader struct, counts comma separated values into a table from chunks of data as they arrive. A field split
+ * between chunks is held back until the rest of it arrives, so the memory used is bounded by the longest field rather
+ * than by the size of the data.
+ */
+struct StreamLoader {
+    struct HashTable *table; // holds the table the keys are counted into, it must intern its keys
+    char *pending; // holds the start of a field whose end hasn't arrived yet
+    size_t pendingLength; // holds the number of bytes held back in pending
+    size_t pendingCapacity; // holds the number of bytes there is room for in pending
+    int state; // holds where the scan of the data got to within a field, one of the STREAM_ states in loader.c
+    long numKeys; // holds the number of keys counted so far
+};
+
+int nextCsvField (char **cursor, char *end, char **field, uint32_t *length);
+long loadKeysIntoTable (struct HashTable *table, char *data, size_t size);
+int initStreamLoader (struct StreamLoader *loader, struct HashTable *table);
+int feedStreamLoader (struct StreamLoader *loader, char *chunk, size_t length);
+long finishStreamLoader (struct StreamLoader *loader);
+long streamKeysIntoTable (struct HashTable *table, int fd);
+
+#endif // LOADER_H
@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "openhashtable.h"
+
+
+/**
+ * A function that creates an open addressing hashtable with a single allocation for all of its entries
+ * @param capacity The number of slots to start with, rounded up to a power of two
+ * @param maxLoadFactor The fraction of slots that can be filled before the table doubles in size, between 0 and 1
+ * @param hashFunction The function used to hash keys, 0 for wyHash
+ * @return The constructed OpenHashTable struct.
+ */
+struct OpenHashTable* constructOpenHashTable (int capacity, double maxLoadFactor, HashFunction hashFunction) {
+    struct OpenHashTable *table = malloc(sizeof(struct OpenHashTable));
+    table->capacity = roundUpToPowerOfTwo(capacity); // a power of two so slots can be found with a mask
+    table->numEntries = 0;
+    table->maxLoadFactor = maxLoadFactor > 0 && maxLoadFactor < 1 ? maxLoadFactor : 0.9; // there must always be a free slot to stop probing at
+    table->hashFunction = hashFunction != 0 ? hashFunction : wyHash;
+    table->seed = randomSeed();
+    table->entries = calloc(table->capacity, sizeof(struct OpenEntry)); // every slot starts with a 0 key, empty
+    return table;
+}
+
+/**
+ * A function to delete and free the memory of an open addressing hashtable
+ * @param table The table to delete
+ */
+void destroyOpenHashTable (struct OpenHashTable *table) {
+    free(table->entries);
+    free(table);
+}
+
+/**
+ * Gets the current load factor of the table, the fraction of slots that are filled
+ * @param table The table to get the load factor of
+ * @return The load factor
+ */
+double getOpenLoadFactor (struct OpenHashTable *table) {
+    return (double) table->numEntries / table->capacity;
+}
+
+/**
+ * Works out which slot an entry with the given hash would ideally be in
+ * @param table The table the entry is in
+ * @param hash The hash of the entry's key
+ * @return The index of the entry's home slot
+ */
+int homeSlot (struct OpenHashTable *table, uint64_t hash) {
+    return (int) (mixHash(hash) & (uint64_t) (table->capacity - 1));
+}
+
+/**
+ * Works out how far an entry is from the slot its hash wants it to be in
+ * @param table The table the entry is in
+ * @param hash The hash of the entry's key
+ * @param index The index of the slot the entry is in
+ * @return The number of slots between the entry and its home slot
+ */
+int probeDistance (struct OpenHashTable *table, uint64_t hash, int index) {
+    int home = homeSlot(table, hash);
+    return (index - home) & (table->capacity - 1);
+}
+
+/**
+ * Places an entry into the table, the Robin Hood way. Whenever the entry being placed is further from home than the
+ * one in the slot, they swap and the displaced entry carries on probing, which keeps every probe sequence short.
+ * @param table The table to place the entry into
+ * @param entry The entry to place
+ */
+void placeEntry (struct OpenHashTable *table, struct OpenEntry entry) {
+    int index = homeSlot(table, entry.hash);
+    int distance = 0;
+    while (table->entries[index].key != 0) {
+        int slotDistance = probeDistance(table, table->entries[index].hash, index);
+        if (slotDistance < distance) { // the entry in this slot is closer to home than ours, so take its place
+            struct OpenEntry displaced = table->entries[index];
+            table->entries[index] = entry;
+            entry = displaced;
+            distance = slotDistance;
+        }
+        index = (index + 1) & (table->capacity - 1);
+        distance++;
+    }
+    table->entries[index] = entry;
+}
+
+/**
+ * Doubles the capacity of the table and places every entry again using the hashes stored with them
+ * @param table The table to grow
+ */
+void growOpenTable (struct OpenHashTable *table) {
+    struct OpenEntry *oldEntries = table->entries;
+    int oldCapacity = table->capacity;
+
+    table->capacity = oldCapacity * 2;
+    table->entries = calloc(table->capacity, sizeof(struct OpenEntry));
+    for (int i = 0; i < oldCapacity; i++) {
+        if (oldEntries[i].key != 0) {
+            placeEntry(table, oldEntries[i]);
+        }
+    }
+    free(oldEntries);
+}
+
+/**
+ * Adds the given key-pair value to the table, growing it first if it would go over its maximum load factor. The key
+ * doesn't need to be null terminated.
+ * @param table The table to add to
+ * @param key The key to add
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ */
+void addToOpenTableWithLength (struct OpenHashTable *table, char *key, uint32_t keyLength, int value) {
+    if (table->numEntries + 1 > table->maxLoadFactor * table->capacity) {
+        growOpenTable(table);
+    }
+    struct OpenEntry entry;
+    entry.key = key;
+    entry.keyLength = keyLength;
+    entry.hash = table->hashFunction(key, keyLength, table->seed);
+    entry.value = value;
+    placeEntry(table, entry);
+    table->numEntries++;
+}
+
+/**
+ * Adds the given key-pair value to the table, growing it first if it would go over its maximum load factor
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ */
+void addToOpenTable (struct OpenHashTable *table, char *key, int value) {
+    addToOpenTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Finds the index of the slot holding a key. The search can stop as soon as it reaches an entry closer to home than
+ * it has probed, since Robin Hood placement would have put the key before that entry.
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The index of the slot with the key in it, -1 if it can't be found
+ */
+int findOpenIndex (struct OpenHashTable *table, char *key, uint32_t keyLength) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    int index = homeSlot(table, keyHash);
+    int distance = 0;
+    while (table->entries[index].key != 0 && distance <= probeDistance(table, table->entries[index].hash, index)) {
+        struct OpenEntry *entry = &table->entries[index];
+        if (entry->hash == keyHash && entry->keyLength == keyLength && (entry->key == key || memcmp(entry->key, key, keyLength) == 0)) { // only compare the keys when the hashes match
+            return index;
+        }
+        index = (index + 1) & (table->capacity - 1);
+        distance++;
+    }
+    return -1;
+}
+
+/**
+ * Searches the table for a key, the key doesn't need to be null terminated
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The entry the key is in, 0 if it can't be found
+ */
+struct OpenEntry* searchOpenTableWithLength (struct OpenHashTable *table, char *key, uint32_t keyLength) {
+    int index = findOpenIndex(table, key, keyLength);
+    return index >= 0 ? &table->entries[index] : 0;
+}
+
+/**
+ * Searches the table for a key
+ * @param table The table to search through
+ * @param key The key to search for
+ * @return The entry the key is in, 0 if it can't be found
+ */
+struct OpenEntry* searchOpenTable (struct OpenHashTable *table, char *key) {
+    return searchOpenTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * A function to remove the key from the table. The entries after it are shifted back a slot until one is found that
+ * is already in its home slot, so no tombstones are needed. The key doesn't need to be null terminated.
+ * @param table The table to remove the key from.
+ * @param key The key to remove.
+ * @param keyLength The length of the key in bytes.
+ */
+void removeFromOpenTableWithLength (struct OpenHashTable *table, char *key, uint32_t keyLength) {
+    int index = findOpenIndex(table, key, keyLength);
+    if (index < 0) return; // nothing to remove
+
+    int next = (index + 1) & (table->capacity - 1);
+    while (table->entries[next].key != 0 && probeDistance(table, table->entries[next].hash, next) > 0) {
+        table->entries[index] = table->entries[next]; // shift the entry back a slot, closer to its home
+        index = next;
+        next = (next + 1) & (table->capacity - 1);
+    }
+    table->entries[index].key = 0; // the last shifted slot becomes empty
+    table->numEntries--;
+}
+
+/**
+ * A function to remove the key from the table.
+ * @param table The table to remove the key from.
+ * @param key The key to remove.
+ */
+void removeFromOpenTable (struct OpenHashTable *table, char *key) {
+    removeFromOpenTableWithLength(table, key, strlen(key));
+}
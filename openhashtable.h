@@ -0,0 +1,42 @@
+#ifndef OPENHASHTABLE_H
+#define OPENHASHTABLE_H
+
+#include <stdint.h>
+
+#include "hash.h"
+
+
+/**
+ * OpenEntry struct, stores a key-value pair directly in the table's entry array along with the hash of the key
+ */
+struct OpenEntry {
+    char *key; // holds a char array representing the key, 0 when the slot is empty
+    uint64_t hash; // holds the hash of the key so it doesn't need recomputing when probing or resizing
+    uint32_t keyLength; // holds the length of the key in bytes
+    int value; // holds the value associated with the key
+};
+
+/**
+ * OpenHashTable struct, an alternative to the chained HashTable that stores every entry in one flat array and
+ * resolves collisions with Robin Hood linear probing
+ */
+struct OpenHashTable {
+    int capacity; // holds the number of slots in the entry array
+    int numEntries; // holds the number of key-value pairs stored in the table
+    double maxLoadFactor; // holds the fraction of slots that can be filled before the table grows
+    HashFunction hashFunction; // holds the function used to hash keys
+    uint64_t seed; // holds the seed passed to the hash function, random for every table
+    struct OpenEntry *entries; // holds the array of entries
+};
+
+struct OpenHashTable* constructOpenHashTable (int capacity, double maxLoadFactor, HashFunction hashFunction);
+void destroyOpenHashTable (struct OpenHashTable *table);
+double getOpenLoadFactor (struct OpenHashTable *table);
+void addToOpenTableWithLength (struct OpenHashTable *table, char *key, uint32_t keyLength, int value);
+void addToOpenTable (struct OpenHashTable *table, char *key, int value);
+struct OpenEntry* searchOpenTableWithLength (struct OpenHashTable *table, char *key, uint32_t keyLength);
+struct OpenEntry* searchOpenTable (struct OpenHashTable *table, char *key);
+void removeFromOpenTableWithLength (struct OpenHashTable *table, char *key, uint32_t keyLength);
+void removeFromOpenTable (struct OpenHashTable *table, char *key);
+
+#endif // OPENHASHTABLE_H
@@ -0,0 +1,292 @@
+#define _GNU_SOURCE // for sched_setaffinity and the CPU_SET macros
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shardedhashtable.h"
+
+
+/**
+ * ShardBuild struct, what a shard's construction thread needs to build the shard on its node
+ */
+struct ShardBuild {
+    struct HashTableShard *shard; // holds the shard to construct the table of
+    struct HashTableOptions options; // holds the options of the shard's table
+};
+
+/**
+ * Reads a list in the kernel's format, such as "0-3,8,10-11", into a set
+ * @param path The path of the file holding the list
+ * @param set The set to fill in
+ * @return 0 if the list was read, -1 if the file couldn't be read
+ */
+int readSysList (const char *path, cpu_set_t *set) {
+    FILE *stream = fopen(path, "r");
+    if (stream == 0) return -1;
+    char list[4096];
+    int read = fgets(list, sizeof(list), stream) != 0;
+    fclose(stream);
+    if (!read) return -1;
+
+    CPU_ZERO(set);
+    char *cursor = list;
+    while (*cursor >= '0' && *cursor <= '9') {
+        long first = strtol(cursor, &cursor, 10);
+        long last = first;
+        if (*cursor == '-') {
+            last = strtol(cursor + 1, &cursor, 10);
+        }
+        for (long i = first; i <= last && i < CPU_SETSIZE; i++) {
+            CPU_SET(i, set);
+        }
+        if (*cursor == ',') cursor++;
+    }
+    return 0;
+}
+
+/**
+ * Finds the NUMA nodes of the machine from sysfs, without needing libnuma
+ * @param nodes Filled in with the id of each online node
+ * @param maxNodes The number of ids there is room for
+ * @return The number of nodes, 0 if the machine doesn't report any
+ */
+int countNumaNodes (int nodes[], int maxNodes) {
+    cpu_set_t online;
+    if (readSysList("/sys/devices/system/node/online", &online) != 0) return 0;
+    int numNodes = 0;
+    for (int i = 0; i < CPU_SETSIZE && numNodes < maxNodes; i++) {
+        if (CPU_ISSET(i, &online)) {
+            nodes[numNodes++] = i;
+        }
+    }
+    return numNodes;
+}
+
+/**
+ * Pins the calling thread to the CPUs of a NUMA node. Memory the thread touches first is then placed on that node by
+ * the kernel's first touch policy, and the memory the thread reads afterwards is local.
+ * @param node The id of the node
+ * @return 0 if the thread was pinned, -1 if the node's CPUs couldn't be read or used
+ */
+int pinThreadToNode (int node) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    cpu_set_t cpus;
+    if (readSysList(path, &cpus) != 0 || CPU_COUNT(&cpus) == 0) return -1; // a node with memory but no CPUs can't be run on
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0 ? 0 : -1;
+}
+
+/**
+ * Constructs a shard's table from a thread pinned to the shard's node, writing its top level buckets so their pages
+ * are first touched there. Only the table and its first bucket array are placed, the buckets added later and the
+ * arrays the table grows into are placed by the threads that add to it. The thread's affinity is only changed for as
+ * long as the thread exists.
+ * @param argument The ShardBuild of the shard
+ * @return 0
+ */
+void* constructShardOnNode (void *argument) {
+    struct ShardBuild *build = argument;
+    if (build->shard->node >= 0 && pinThreadToNode(build->shard->node) != 0) {
+        build->shard->node = -1; // constructed anyway, wherever the kernel puts it
+    }
+    struct HashTable *table = constructHashTableWithOptions(&build->options);
+    memset(table->buckets, 0, sizeof(struct Bucket *) * table->numBuckets); // calloc's pages aren't placed until written
+    build->shard->table = table;
+    return 0;
+}
+
+/**
+ * A function that creates a sharded hashtable, each shard's table being constructed on its own NUMA node
+ * @param options The options every shard's table is constructed with, the number of buckets is split between the shards
+ * @param numShards The number of shards, rounded up to a power of two
+ * @return The constructed ShardedHashTable struct, 0 if the shards couldn't be allocated on their own cache lines
+ */
+struct ShardedHashTable* constructShardedHashTable (const struct HashTableOptions *options, int numShards) {
+    struct ShardedHashTable *table = malloc(sizeof(struct ShardedHashTable));
+    table->numShards = roundUpToPowerOfTwo(numShards > 0 ? numShards : 1);
+    table->shardBits = 0;
+    while ((1 << table->shardBits) < table->numShards) {
+        table->shardBits++;
+    }
+    table->hashFunction = options->hashFunction != 0 ? options->hashFunction : wyHash;
+    table->seed = options->seed;
+    if (posix_memalign((void **) &table->shards, 64, sizeof(struct HashTableShard) * table->numShards) != 0) { // aligned so no two shards share a cache line
+        free(table); // malloc's memory isn't aligned enough for a HashTableShard
+        return 0;
+    }
+
+    int nodes[MAX_NUMA_NODES];
+    table->numNodes = countNumaNodes(nodes, MAX_NUMA_NODES);
+    struct ShardBuild build;
+    build.options = *options;
+    build.options.numBuckets = options->numBuckets / table->numShards > 0 ? options->numBuckets / table->numShards : 1;
+    build.options.hashFunction = table->hashFunction; // so the hash that routes a key can be used by its shard as well
+    build.options.powerOfTwoBuckets = 1; // scaling the mixed hash onto the buckets would use the same high bits as the routing
+    for (int i = 0; i < table->numShards; i++) { // one at a time, construction is cheap next to filling the table
+        struct HashTableShard *shard = &table->shards[i];
+        pthread_mutex_init(&shard->lock, 0);
+        shard->node = table->numNodes > 0 ? nodes[i % table->numNodes] : -1; // spread the shards over the nodes in turn
+        build.shard = shard;
+        pthread_t thread;
+        if (pthread_create(&thread, 0, constructShardOnNode, &build) == 0) {
+            pthread_join(thread, 0);
+        } else {
+            shard->node = -1;
+            constructShardOnNode(&build);
+        }
+    }
+    if (table->numNodes == 0) {
+        table->numNodes = 1;
+    }
+    return table;
+}
+
+/**
+ * A function to delete and free the memory of a sharded hashtable and every shard's table
+ * @param table The table to delete
+ */
+void destroyShardedHashTable (struct ShardedHashTable *table) {
+    for (int i = 0; i < table->numShards; i++) {
+        destroyHashTable(table->shards[i].table);
+        pthread_mutex_destroy(&table->shards[i].lock);
+    }
+    free(table->shards);
+    free(table);
+}
+
+/**
+ * Works out which shard a key belongs in from its hash
+ * @param table The table the key belongs to
+ * @param keyHash The hash of the key, made by the table's hash function and seed
+ * @return The index of the shard
+ */
+int shardOfHash (struct ShardedHashTable *table, uint64_t keyHash) {
+    if (table->shardBits == 0) return 0; // a shift by 64 isn't defined
+    return (int) (mixHash(keyHash) >> (64 - table->shardBits)); // mixed the same way as in the shards, which mask off the low bits
+}
+
+/**
+ * Works out which shard a key belongs in, so work can be split between workers by shard before it is done
+ * @param table The table the key belongs to
+ * @param key The key, not necessarily null terminated
+ * @param keyLength The length of the key in bytes
+ * @return The index of the shard
+ */
+int shardOfKey (struct ShardedHashTable *table, const char *key, uint32_t keyLength) {
+    return shardOfHash(table, table->hashFunction(key, keyLength, table->seed));
+}
+
+/**
+ * Gets the hash a shard's table needs for a key, the routing hash unless the shard has since rehashed itself with a
+ * new seed. The shard's lock must be held.
+ * @param table The table the shard belongs to
+ * @param shard The shard
+ * @param key The key, not necessarily null terminated
+ * @param keyLength The length of the key in bytes
+ * @param keyHash The routing hash of the key
+ * @return The hash of the key in the shard's table
+ */
+uint64_t shardHash (struct ShardedHashTable *table, struct HashTableShard *shard, char *key, uint32_t keyLength, uint64_t keyHash) {
+    struct HashTable *shardTable = shard->table;
+    if (shardTable->hashFunction == table->hashFunction && shardTable->seed == table->seed) return keyHash;
+    return shardTable->hashFunction(key, keyLength, shardTable->seed);
+}
+
+/**
+ * Gets the current load factor of the table, the average number of entries per top level bucket over every shard
+ * @param table The table to get the load factor of
+ * @return The load factor
+ */
+double getShardedLoadFactor (struct ShardedHashTable *table) {
+    long numEntries = 0;
+    long numBuckets = 0;
+    for (int i = 0; i < table->numShards; i++) {
+        struct HashTableShard *shard = &table->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        numEntries += shard->table->numEntries;
+        numBuckets += shard->table->newBuckets != 0 ? shard->table->numNewBuckets : shard->table->numBuckets;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return (double) numEntries / numBuckets;
+}
+
+/**
+ * Adds the given key-pair value to the shard the key belongs in, the key doesn't need to be null terminated
+ * @param table The table to add to
+ * @param key The key to add, it must stay in memory as long as it is in the table
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ */
+void addToShardedTableWithLength (struct ShardedHashTable *table, char *key, uint32_t keyLength, int value) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    struct HashTableShard *shard = &table->shards[shardOfHash(table, keyHash)];
+    pthread_mutex_lock(&shard->lock);
+    addToTableWithHash(shard->table, key, keyLength, shardHash(table, shard, key, keyLength, keyHash), value);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * Adds the given key-pair value to the shard the key belongs in
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ */
+void addToShardedTable (struct ShardedHashTable *table, char *key, int value) {
+    addToShardedTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Searches the shard a key belongs in for the key, the key doesn't need to be null terminated. The value is copied
+ * out under the shard's lock, since the bucket it is in may be removed as soon as the lock is let go.
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @param value Set to the value stored for the key if it is found
+ * @return 1 if the key was found, 0 otherwise
+ */
+int searchShardedTableWithLength (struct ShardedHashTable *table, char *key, uint32_t keyLength, int *value) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    struct HashTableShard *shard = &table->shards[shardOfHash(table, keyHash)];
+    pthread_mutex_lock(&shard->lock); // searching can migrate buckets, so it needs the lock as much as adding does
+    struct Bucket *bucket = searchTableWithHash(shard->table, key, keyLength, shardHash(table, shard, key, keyLength, keyHash));
+    if (bucket != 0) {
+        *value = bucket->value;
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return bucket != 0;
+}
+
+/**
+ * Searches the shard a key belongs in for the key
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param value Set to the value stored for the key if it is found
+ * @return 1 if the key was found, 0 otherwise
+ */
+int searchShardedTable (struct ShardedHashTable *table, char *key, int *value) {
+    return searchShardedTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * A function to remove the key from the shard it belongs in, the key doesn't need to be null terminated
+ * @param table The table to remove the key from
+ * @param key The key to remove
+ * @param keyLength The length of the key in bytes
+ */
+void removeFromShardedTableWithLength (struct ShardedHashTable *table, char *key, uint32_t keyLength) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    struct HashTableShard *shard = &table->shards[shardOfHash(table, keyHash)];
+    pthread_mutex_lock(&shard->lock);
+    removeFromTableWithHash(shard->table, key, keyLength, shardHash(table, shard, key, keyLength, keyHash));
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * A function to remove the key from the shard it belongs in
+ * @param table The table to remove the key from
+ * @param key The key to remove
+ */
+void removeFromShardedTable (struct ShardedHashTable *table, char *key) {
+    removeFromShardedTableWithLength(table, key, strlen(key));
+}
@@ -0,0 +1,58 @@
+#ifndef SHARDEDHASHTABLE_H
+#define SHARDEDHASHTABLE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "hash.h"
+#include "hashtable.h"
+
+#define MAX_NUMA_NODES 64 // the most NUMA nodes shards are spread over, any past this are left unused
+
+
+/**
+ * HashTableShard struct, one independent table of a sharded table along with the lock its users take
+ */
+struct HashTableShard {
+    pthread_mutex_t lock; // holds the lock taken around every operation on the shard's table
+    struct HashTable *table; // holds the shard's table, constructed by a thread running on the shard's node
+    int node; // holds the NUMA node the shard's memory was placed on, -1 if it couldn't be placed
+} __attribute__((aligned(64))); // keep each shard on its own cache lines so threads using different shards don't contend
+
+/**
+ * ShardedHashTable struct, splits keys between a number of independent HashTables by the high bits of each key's hash.
+ * Every shard's table is built with the same hash function and seed as the router, so the one hash picks the shard by
+ * the high bits of its mixed value and is then handed down for the shard to index its buckets by the low bits. A key
+ * is only hashed again if its shard has rehashed itself after finding a long chain. Each shard grows on its own, so a
+ * resize only ever stalls the users of one shard.
+ *
+ * The shards are spread over the NUMA nodes of the machine in turn, but only a shard's table header and first array of
+ * top level buckets are placed on its node when it is constructed. Its buckets come from its pool later, and the
+ * larger array it grows into is allocated while it grows, so that memory is placed on the node of whichever thread
+ * first touches it. Nothing here enforces that, so for every shard's memory to stay local its adds must come from a
+ * worker pinned to the shard's node with pinThreadToNode, given only the keys routed to that node's shards.
+ */
+struct ShardedHashTable {
+    int numShards; // holds the number of shards, a power of two
+    int shardBits; // holds the number of high bits of the routing hash that pick a shard
+    HashFunction hashFunction; // holds the function keys are hashed with, the one every shard's table starts with
+    uint64_t seed; // holds the seed keys are hashed with, the one every shard's table starts with
+    int numNodes; // holds the number of NUMA nodes the shards are spread over, 1 on a machine without NUMA
+    struct HashTableShard *shards; // holds the array of shards
+};
+
+int countNumaNodes (int nodes[], int maxNodes);
+int pinThreadToNode (int node);
+struct ShardedHashTable* constructShardedHashTable (const struct HashTableOptions *options, int numShards);
+void destroyShardedHashTable (struct ShardedHashTable *table);
+int shardOfHash (struct ShardedHashTable *table, uint64_t keyHash);
+int shardOfKey (struct ShardedHashTable *table, const char *key, uint32_t keyLength);
+double getShardedLoadFactor (struct ShardedHashTable *table);
+void addToShardedTableWithLength (struct ShardedHashTable *table, char *key, uint32_t keyLength, int value);
+void addToShardedTable (struct ShardedHashTable *table, char *key, int value);
+int searchShardedTableWithLength (struct ShardedHashTable *table, char *key, uint32_t keyLength, int *value);
+int searchShardedTable (struct ShardedHashTable *table, char *key, int *value);
+void removeFromShardedTableWithLength (struct ShardedHashTable *table, char *key, uint32_t keyLength);
+void removeFromShardedTable (struct ShardedHashTable *table, char *key);
+
+#endif // SHARDEDHASHTABLE_H
@@ -0,0 +1,261 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "snapshot.h"
+
+
+/**
+ * Works out which of the known hash functions a table uses, only their hashes mean the same thing in another process
+ * @param hashFunction The hash function
+ * @return The id to store for it, 0 if it isn't one that can be stored
+ */
+uint32_t snapshotHashId (HashFunction hashFunction) {
+    if (hashFunction == wyHash) return SNAPSHOT_HASH_WYHASH;
+    if (hashFunction == djb2Hash) return SNAPSHOT_HASH_DJB2;
+    if (hashFunction == sipHash) return SNAPSHOT_HASH_SIPHASH;
+    return 0;
+}
+
+/**
+ * Gets the hash function a snapshot's hashes were made by
+ * @param hashId The id stored in the snapshot
+ * @return The hash function, 0 if the id isn't one this version knows
+ */
+HashFunction snapshotHashFunction (uint32_t hashId) {
+    if (hashId == SNAPSHOT_HASH_WYHASH) return wyHash;
+    if (hashId == SNAPSHOT_HASH_DJB2) return djb2Hash;
+    if (hashId == SNAPSHOT_HASH_SIPHASH) return sipHash;
+    return 0;
+}
+
+/**
+ * Works out which bucket of a snapshot a hash belongs in
+ * @param keyHash The hash of the key
+ * @param numBuckets The number of buckets, a power of two
+ * @return The index of the bucket
+ */
+uint64_t snapshotBucket (uint64_t keyHash, uint64_t numBuckets) {
+    return mixHash(keyHash) & (numBuckets - 1);
+}
+
+/**
+ * Writes the sections of a snapshot to a stream
+ * @param stream The stream to write to
+ * @param header The header
+ * @param buckets Where each bucket's entries start, header->numBuckets + 1 of them
+ * @param entries The entries, grouped by bucket
+ * @param keys The keys
+ * @return 0 if everything was written, -1 otherwise
+ */
+int writeSnapshot (FILE *stream, const struct SnapshotHeader *header, const uint64_t *buckets, const struct SnapshotEntry *entries, const char *keys) {
+    if (fwrite(header, sizeof(struct SnapshotHeader), 1, stream) != 1) return -1;
+    if (fwrite(buckets, sizeof(uint64_t), header->numBuckets + 1, stream) != header->numBuckets + 1) return -1;
+    if (header->numEntries > 0 && fwrite(entries, sizeof(struct SnapshotEntry), header->numEntries, stream) != header->numEntries) return -1;
+    if (header->keysSize > 0 && fwrite(keys, 1, header->keysSize, stream) != header->keysSize) return -1;
+    return 0;
+}
+
+/**
+ * A function to save a table to a snapshot file that loadHashTable can map back in. The entries are grouped by bucket
+ * in one flat array with their hashes, and the keys are copied into the file, so loading needs no hashing, parsing or
+ * allocating. The file is written beside the path and renamed over it, so a reader never sees half a snapshot. Only
+ * tables hashed with wyHash, djb2Hash or sipHash can be saved, along with the seed they were hashed with.
+ * @param table The table to save
+ * @param path The path of the file to write
+ * @return 0 if the snapshot was saved, -1 otherwise
+ */
+int saveHashTable (struct HashTable *table, const char *path) {
+    struct SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.hashId = snapshotHashId(table->hashFunction);
+    if (header.hashId == 0) return -1; // nothing could look the keys up again
+    header.seed = table->seed;
+
+    header.numEntries = table->numEntries;
+    header.numBuckets = 1;
+    while (header.numBuckets < header.numEntries) { // about one entry per bucket
+        header.numBuckets <<= 1;
+    }
+
+    uint64_t *buckets = calloc(header.numBuckets + 1, sizeof(uint64_t));
+    struct HashTableIterator iterator;
+    initHashTableIterator(table, &iterator);
+    for (struct Bucket *bucket = nextTableBucket(&iterator); bucket != 0; bucket = nextTableBucket(&iterator)) { // count the entries of each bucket
+        buckets[snapshotBucket(bucket->hash, header.numBuckets) + 1]++;
+        header.keysSize += bucket->keyLength;
+    }
+    for (uint64_t i = 0; i < header.numBuckets; i++) { // turn the counts into where each bucket starts
+        buckets[i + 1] += buckets[i];
+    }
+
+    struct SnapshotEntry *entries = malloc(sizeof(struct SnapshotEntry) * (header.numEntries > 0 ? header.numEntries : 1));
+    char *keys = malloc(header.keysSize > 0 ? header.keysSize : 1);
+    uint64_t *next = malloc(sizeof(uint64_t) * header.numBuckets); // where the next entry of each bucket goes
+    memcpy(next, buckets, sizeof(uint64_t) * header.numBuckets);
+    uint64_t keyOffset = 0;
+    initHashTableIterator(table, &iterator);
+    for (struct Bucket *bucket = nextTableBucket(&iterator); bucket != 0; bucket = nextTableBucket(&iterator)) {
+        struct SnapshotEntry *entry = &entries[next[snapshotBucket(bucket->hash, header.numBuckets)]++];
+        entry->hash = bucket->hash;
+        entry->keyOffset = keyOffset;
+        entry->keyLength = bucket->keyLength;
+        entry->value = bucket->value;
+        memcpy(keys + keyOffset, bucketKey(bucket), bucket->keyLength);
+        keyOffset += bucket->keyLength;
+    }
+    free(next);
+
+    header.bucketsOffset = sizeof(struct SnapshotHeader);
+    header.entriesOffset = header.bucketsOffset + sizeof(uint64_t) * (header.numBuckets + 1);
+    header.keysOffset = header.entriesOffset + sizeof(struct SnapshotEntry) * header.numEntries;
+
+    size_t pathLength = strlen(path);
+    char *temporaryPath = malloc(pathLength + 5);
+    memcpy(temporaryPath, path, pathLength);
+    memcpy(temporaryPath + pathLength, ".tmp", 5);
+    int result = -1;
+    FILE *stream = fopen(temporaryPath, "wb");
+    if (stream != 0) {
+        result = writeSnapshot(stream, &header, buckets, entries, keys);
+        if (fclose(stream) != 0) {
+            result = -1;
+        }
+        if (result == 0 && rename(temporaryPath, path) != 0) {
+            result = -1;
+        }
+        if (result != 0) {
+            remove(temporaryPath);
+        }
+    }
+
+    free(temporaryPath);
+    free(keys);
+    free(entries);
+    free(buckets);
+    return result;
+}
+
+/**
+ * Checks that a section of a snapshot lies within the file
+ * @param size The size of the file
+ * @param offset The offset of the section
+ * @param count The number of items in the section
+ * @param itemSize The size of each item
+ * @return 1 if the section fits, 0 otherwise
+ */
+int snapshotSectionFits (size_t size, uint64_t offset, uint64_t count, size_t itemSize) {
+    if (offset > size || offset % sizeof(uint64_t) != 0) return 0;
+    return count <= (size - offset) / itemSize;
+}
+
+/**
+ * A function to map a snapshot saved by saveHashTable and serve lookups straight from it. The header and the section
+ * bounds are checked, but nothing is hashed, copied or allocated beyond the MappedHashTable struct itself, so loading
+ * takes the same time however big the snapshot is.
+ * @param path The path of the snapshot file
+ * @return The mapped table, 0 if the file couldn't be mapped or isn't a snapshot this version can read
+ */
+struct MappedHashTable* loadHashTable (const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(struct SnapshotHeader)) {
+        close(fd);
+        return 0;
+    }
+    size_t size = info.st_size;
+    void *data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after the file is closed
+    if (data == MAP_FAILED) return 0;
+
+    const struct SnapshotHeader *header = data;
+    int valid = memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0
+        && header->version == SNAPSHOT_VERSION
+        && header->byteOrder == SNAPSHOT_BYTE_ORDER
+        && snapshotHashFunction(header->hashId) != 0
+        && header->numBuckets > 0 && (header->numBuckets & (header->numBuckets - 1)) == 0
+        && snapshotSectionFits(size, header->bucketsOffset, header->numBuckets + 1, sizeof(uint64_t))
+        && snapshotSectionFits(size, header->entriesOffset, header->numEntries, sizeof(struct SnapshotEntry))
+        && header->keysOffset <= size && header->keysSize <= size - header->keysOffset;
+    if (valid) { // every bucket's entries must lie within the entry array
+        const uint64_t *buckets = (const uint64_t *) ((const char *) data + header->bucketsOffset);
+        valid = buckets[header->numBuckets] == header->numEntries;
+    }
+    if (!valid) {
+        munmap(data, size);
+        return 0;
+    }
+
+    madvise(data, size, MADV_WILLNEED); // start reading the file in the background, lookups don't wait for it
+    struct MappedHashTable *table = malloc(sizeof(struct MappedHashTable));
+    table->data = data;
+    table->size = size;
+    table->header = header;
+    table->buckets = (const uint64_t *) (table->data + header->bucketsOffset);
+    table->entries = (const struct SnapshotEntry *) (table->data + header->entriesOffset);
+    table->keys = table->data + header->keysOffset;
+    table->hashFunction = snapshotHashFunction(header->hashId);
+    table->seed = header->seed;
+    return table;
+}
+
+/**
+ * A function to unmap a snapshot and free its table, any entries or keys found in it must no longer be used
+ * @param table The table to close
+ */
+void closeMappedHashTable (struct MappedHashTable *table) {
+    munmap((void *) table->data, table->size);
+    free(table);
+}
+
+/**
+ * Searches a mapped snapshot for a key, the key doesn't need to be null terminated
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The entry the key is in, 0 if it can't be found
+ */
+const struct SnapshotEntry* searchMappedTableWithLength (struct MappedHashTable *table, const char *key, uint32_t keyLength) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    uint64_t bucket = snapshotBucket(keyHash, table->header->numBuckets);
+    uint64_t end = table->buckets[bucket + 1];
+    if (end > table->header->numEntries) return 0; // a damaged file, don't read past the entries
+
+    for (uint64_t i = table->buckets[bucket]; i < end; i++) {
+        const struct SnapshotEntry *entry = &table->entries[i];
+        if (entry->hash == keyHash && entry->keyLength == keyLength && keyLength <= table->header->keysSize && entry->keyOffset <= table->header->keysSize - keyLength
+            && memcmp(table->keys + entry->keyOffset, key, keyLength) == 0) { // only compare the keys when the hashes match
+            return entry;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Searches a mapped snapshot for a key
+ * @param table The table to search through
+ * @param key The key to search for
+ * @return The entry the key is in, 0 if it can't be found
+ */
+const struct SnapshotEntry* searchMappedTable (struct MappedHashTable *table, const char *key) {
+    return searchMappedTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * Gets the key of an entry of a mapped snapshot
+ * @param table The table the entry is in
+ * @param entry The entry
+ * @return The key, entry->keyLength bytes long and not null terminated
+ */
+const char* mappedEntryKey (struct MappedHashTable *table, const struct SnapshotEntry *entry) {
+    return table->keys + entry->keyOffset;
+}
@@ -0,0 +1,70 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash.h"
+#include "hashtable.h"
+
+#define SNAPSHOT_MAGIC "HTSNAPSH" // the first eight bytes of every snapshot file
+#define SNAPSHOT_VERSION 2 // bumped whenever the layout changes, older layouts are refused rather than misread
+#define SNAPSHOT_BYTE_ORDER 0x01020304u // written in the saving machine's byte order so a mismatch can be detected
+
+#define SNAPSHOT_HASH_WYHASH 1 // the key hashes were made by wyHash
+#define SNAPSHOT_HASH_DJB2 2 // the key hashes were made by djb2Hash
+#define SNAPSHOT_HASH_SIPHASH 3 // the key hashes were made by sipHash
+
+
+/**
+ * SnapshotHeader struct, the start of a snapshot file. Every section is found from an offset from the start of the
+ * file, so the file means the same wherever it is mapped.
+ */
+struct SnapshotHeader {
+    char magic[8]; // holds SNAPSHOT_MAGIC
+    uint32_t version; // holds SNAPSHOT_VERSION
+    uint32_t byteOrder; // holds SNAPSHOT_BYTE_ORDER
+    uint32_t hashId; // holds which hash function made the stored hashes
+    uint32_t reserved; // holds 0, keeps the offsets aligned
+    uint64_t numEntries; // holds the number of entries
+    uint64_t numBuckets; // holds the number of buckets, a power of two
+    uint64_t bucketsOffset; // holds the offset of numBuckets + 1 entry indexes, bucket i's entries are [buckets[i], buckets[i + 1])
+    uint64_t entriesOffset; // holds the offset of the entries, grouped by bucket
+    uint64_t keysOffset; // holds the offset of the keys, stored one after another
+    uint64_t keysSize; // holds the number of bytes of keys
+    uint64_t seed; // holds the seed the stored hashes were made with
+};
+
+/**
+ * SnapshotEntry struct, one key-value pair of a snapshot
+ */
+struct SnapshotEntry {
+    uint64_t hash; // holds the hash of the key, compared before the key itself
+    uint64_t keyOffset; // holds the offset of the key from the start of the keys
+    uint32_t keyLength; // holds the length of the key in bytes
+    int32_t value; // holds the value associated with the key
+};
+
+/**
+ * MappedHashTable struct, a read-only table served straight from a mapped snapshot file. Loading it reads nothing but
+ * the header, the pages of the file are only read in as lookups touch them.
+ */
+struct MappedHashTable {
+    const char *data; // holds the first byte of the mapping
+    size_t size; // holds the size of the mapping in bytes
+    const struct SnapshotHeader *header; // holds the header at the start of the mapping
+    const uint64_t *buckets; // holds where each bucket's entries start
+    const struct SnapshotEntry *entries; // holds the entries
+    const char *keys; // holds the keys
+    HashFunction hashFunction; // holds the function the stored hashes were made by
+    uint64_t seed; // holds the seed the stored hashes were made with
+};
+
+int saveHashTable (struct HashTable *table, const char *path);
+struct MappedHashTable* loadHashTable (const char *path);
+void closeMappedHashTable (struct MappedHashTable *table);
+const struct SnapshotEntry* searchMappedTableWithLength (struct MappedHashTable *table, const char *key, uint32_t keyLength);
+const struct SnapshotEntry* searchMappedTable (struct MappedHashTable *table, const char *key);
+const char* mappedEntryKey (struct MappedHashTable *table, const struct SnapshotEntry *entry);
+
+#endif // SNAPSHOT_H
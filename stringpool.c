@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashtable.h"
+#include "stringpool.h"
+
+
+/**
+ * A function to set up an empty string pool, no memory is allocated until a string is added
+ * @param pool The pool to set up
+ */
+void initStringPool (struct StringPool *pool) {
+    pool->blocks = 0;
+    pool->numBlocks = 0;
+    pool->blocksCapacity = 0;
+    pool->used = 0;
+    pool->lastSize = 0;
+    pool->bytesAllocated = 0;
+    pool->index = 0;
+}
+
+/**
+ * A function to free every block of a string pool, every handle and string it gave out must no longer be used. The
+ * pool is left empty and can be used again.
+ * @param pool The pool to release
+ */
+void releaseStringPool (struct StringPool *pool) {
+    for (uint32_t i = 0; i < pool->numBlocks; i++) {
+        free(pool->blocks[i]);
+    }
+    free(pool->blocks);
+    if (pool->index != 0) {
+        destroyHashTable(pool->index);
+    }
+    initStringPool(pool);
+}
+
+/**
+ * Starts a new block in a pool, big enough for at least the given number of bytes
+ * @param pool The pool to add the block to
+ * @param size The number of bytes the block must hold
+ * @return 0 if the block was added, -1 if the pool already has as many blocks as a handle can name or there wasn't the
+ *         memory, in which case the pool is left as it was
+ */
+int addStringBlock (struct StringPool *pool, size_t size) {
+    if (pool->numBlocks == STRING_POOL_MAX_BLOCKS) return -1;
+    if (pool->numBlocks == pool->blocksCapacity) {
+        uint32_t blocksCapacity = pool->blocksCapacity > 0 ? pool->blocksCapacity * 2 : 16;
+        char **blocks = realloc(pool->blocks, sizeof(char *) * blocksCapacity);
+        if (blocks == 0) return -1;
+        pool->blocks = blocks;
+        pool->blocksCapacity = blocksCapacity;
+    }
+    size_t blockSize = size > STRING_POOL_BLOCK_SIZE ? size : STRING_POOL_BLOCK_SIZE;
+    char *block = malloc(blockSize);
+    if (block == 0) return -1;
+    pool->lastSize = blockSize;
+    pool->blocks[pool->numBlocks++] = block;
+    pool->bytesAllocated += pool->lastSize;
+    pool->used = 0;
+    return 0;
+}
+
+/**
+ * Copies a string onto the end of a pool, even if the same string is already in it
+ * @param pool The pool to add to
+ * @param string The string, not necessarily null terminated
+ * @param length The length of the string in bytes
+ * @return The handle of the copy, INVALID_STRING_HANDLE if the pool is full or there wasn't the memory
+ */
+uint32_t appendString (struct StringPool *pool, const char *string, uint32_t length) {
+    size_t size = (sizeof(uint32_t) + (size_t) length + 1 + STRING_POOL_ALIGNMENT - 1) & ~(size_t) (STRING_POOL_ALIGNMENT - 1); // the length, the string and its terminator
+    if (pool->numBlocks == 0 || size > pool->lastSize - pool->used) { // the rest of the last block is left unused
+        if (addStringBlock(pool, size) != 0) return INVALID_STRING_HANDLE;
+    }
+
+    char *slot = pool->blocks[pool->numBlocks - 1] + pool->used;
+    memcpy(slot, &length, sizeof(uint32_t));
+    memcpy(slot + sizeof(uint32_t), string, length);
+    slot[sizeof(uint32_t) + length] = '\0';
+    uint32_t handle = ((pool->numBlocks - 1) << STRING_POOL_OFFSET_BITS) | (uint32_t) (pool->used / STRING_POOL_ALIGNMENT);
+    pool->used += size;
+    return handle;
+}
+
+/**
+ * Finds the handle of a string in a pool, copying the string in first if it isn't there already
+ * @param pool The pool to look in
+ * @param string The string, not necessarily null terminated
+ * @param length The length of the string in bytes
+ * @return The handle of the string, the same for every call with an equal string, INVALID_STRING_HANDLE if the
+ *         string isn't in the pool and the pool is full
+ */
+uint32_t internString (struct StringPool *pool, const char *string, uint32_t length) {
+    if (pool->index == 0) {
+        struct HashTableOptions options = defaultHashTableOptions();
+        pool->index = constructHashTableWithOptions(&options); // keys point into the pool itself, so it never copies them
+    }
+    struct Bucket *existing = searchTableWithLength(pool->index, (char *) string, length);
+    if (existing != 0) {
+        return (uint32_t) existing->value;
+    }
+
+    uint32_t handle = appendString(pool, string, length);
+    if (handle != INVALID_STRING_HANDLE) {
+        addToTableWithLength(pool->index, poolString(pool, handle), length, (int) handle);
+    }
+    return handle;
+}
+
+/**
+ * Finds the handle of a string that was interned in a pool, without adding it
+ * @param pool The pool to look in
+ * @param string The string, not necessarily null terminated
+ * @param length The length of the string in bytes
+ * @return The handle of the string, INVALID_STRING_HANDLE if it was never interned
+ */
+uint32_t findInternedString (struct StringPool *pool, const char *string, uint32_t length) {
+    if (pool->index == 0) return INVALID_STRING_HANDLE;
+    struct Bucket *existing = searchTableWithLength(pool->index, (char *) string, length);
+    return existing != 0 ? (uint32_t) existing->value : INVALID_STRING_HANDLE;
+}
+
+/**
+ * Gets the string a handle names
+ * @param pool The pool the handle came from
+ * @param handle The handle
+ * @return The string, null terminated and valid until the pool is released
+ */
+char* poolString (const struct StringPool *pool, uint32_t handle) {
+    char *slot = pool->blocks[handle >> STRING_POOL_OFFSET_BITS] + (size_t) (handle & ((1u << STRING_POOL_OFFSET_BITS) - 1)) * STRING_POOL_ALIGNMENT;
+    return slot + sizeof(uint32_t);
+}
+
+/**
+ * Gets the length of the string a handle names, without reading the string
+ * @param pool The pool the handle came from
+ * @param handle The handle
+ * @return The length of the string in bytes
+ */
+uint32_t poolStringLength (const struct StringPool *pool, uint32_t handle) {
+    uint32_t length;
+    memcpy(&length, poolString(pool, handle) - sizeof(uint32_t), sizeof(uint32_t));
+    return length;
+}
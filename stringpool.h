@@ -0,0 +1,41 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define STRING_POOL_OFFSET_BITS 16 // the low bits of a handle, the offset of the string within its block
+#define STRING_POOL_ALIGNMENT 4 // every string starts on a multiple of this, so offsets are stored in units of it
+#define STRING_POOL_BLOCK_SIZE (((size_t) 1 << STRING_POOL_OFFSET_BITS) * STRING_POOL_ALIGNMENT) // 256KB, as far as an offset reaches
+#define STRING_POOL_MAX_BLOCKS (((uint32_t) 1 << (32 - STRING_POOL_OFFSET_BITS)) - 1) // the last block index is left out so no string gets the invalid handle
+#define INVALID_STRING_HANDLE UINT32_MAX // returned when the pool is full
+
+struct HashTable;
+
+
+/**
+ * StringPool struct, an append-only store of strings in large blocks. Each string is kept after its length and
+ * before a null terminator, and is named by a 32 bit handle, the index of its block in the high bits and its offset in
+ * the low bits. Strings never move, so a handle and the pointer it gives stay valid until the pool is released.
+ * Strings added with internString are only stored once, so two interned strings are equal exactly when their handles
+ * are.
+ */
+struct StringPool {
+    char **blocks; // holds the blocks in the order they were allocated, a longer string than a block holds gets one of its own
+    uint32_t numBlocks; // holds the number of blocks
+    uint32_t blocksCapacity; // holds the number of blocks there is room for in blocks
+    size_t used; // holds the number of bytes used in the last block
+    size_t lastSize; // holds the size of the last block in bytes
+    size_t bytesAllocated; // holds the total size of every block
+    struct HashTable *index; // holds every interned string with its handle as the value, 0 until internString is first called
+};
+
+void initStringPool (struct StringPool *pool);
+void releaseStringPool (struct StringPool *pool);
+uint32_t appendString (struct StringPool *pool, const char *string, uint32_t length);
+uint32_t internString (struct StringPool *pool, const char *string, uint32_t length);
+uint32_t findInternedString (struct StringPool *pool, const char *string, uint32_t length);
+char* poolString (const struct StringPool *pool, uint32_t handle);
+uint32_t poolStringLength (const struct StringPool *pool, uint32_t handle);
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,335 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "swisshashtable.h"
+
+
+#if defined(__SSE2__)
+
+/**
+ * Finds every slot of a group whose control byte is the one given
+ * @param group The first control byte of the group
+ * @param byte The control byte to look for
+ * @return A mask with bit i set if slot i of the group matches
+ */
+uint32_t matchControlByte (const int8_t *group, int8_t byte) {
+    __m128i controls = _mm_loadu_si128((const __m128i *) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8(byte)));
+}
+
+/**
+ * Finds every slot of a group that is empty or deleted, both of which have the top bit of their control byte set
+ * @param group The first control byte of the group
+ * @return A mask with bit i set if slot i of the group is free
+ */
+uint32_t matchFreeSlot (const int8_t *group) {
+    return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) group));
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+/**
+ * Packs the result of a NEON byte comparison into a mask with a bit per byte, as SSE2's movemask does
+ * @param compared The comparison, each byte all ones or all zeros
+ * @return A mask with bit i set if byte i was all ones
+ */
+uint32_t neonMoveMask (uint8x16_t compared) {
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t weighted = vandq_u8(compared, vld1q_u8(weights));
+    return (uint32_t) vaddv_u8(vget_low_u8(weighted)) | ((uint32_t) vaddv_u8(vget_high_u8(weighted)) << 8);
+}
+
+/**
+ * Finds every slot of a group whose control byte is the one given
+ * @param group The first control byte of the group
+ * @param byte The control byte to look for
+ * @return A mask with bit i set if slot i of the group matches
+ */
+uint32_t matchControlByte (const int8_t *group, int8_t byte) {
+    return neonMoveMask(vceqq_s8(vld1q_s8(group), vdupq_n_s8(byte)));
+}
+
+/**
+ * Finds every slot of a group that is empty or deleted, both of which have the top bit of their control byte set
+ * @param group The first control byte of the group
+ * @return A mask with bit i set if slot i of the group is free
+ */
+uint32_t matchFreeSlot (const int8_t *group) {
+    return neonMoveMask(vcltq_s8(vld1q_s8(group), vdupq_n_s8(0)));
+}
+
+#else
+
+/**
+ * Finds every slot of a group whose control byte is the one given
+ * @param group The first control byte of the group
+ * @param byte The control byte to look for
+ * @return A mask with bit i set if slot i of the group matches
+ */
+uint32_t matchControlByte (const int8_t *group, int8_t byte) {
+    uint32_t mask = 0;
+    for (int i = 0; i < SWISS_GROUP_WIDTH; i++) {
+        mask |= (uint32_t) (group[i] == byte) << i;
+    }
+    return mask;
+}
+
+/**
+ * Finds every slot of a group that is empty or deleted, both of which have the top bit of their control byte set
+ * @param group The first control byte of the group
+ * @return A mask with bit i set if slot i of the group is free
+ */
+uint32_t matchFreeSlot (const int8_t *group) {
+    uint32_t mask = 0;
+    for (int i = 0; i < SWISS_GROUP_WIDTH; i++) {
+        mask |= (uint32_t) (group[i] < 0) << i;
+    }
+    return mask;
+}
+
+#endif
+
+/**
+ * Works out how many slots can be filled or deleted before a table of the given capacity has to be resized
+ * @param table The table
+ * @param capacity The number of slots
+ * @return The number of slots, always leaving at least one empty so probing stops
+ */
+int maxSwissGrowth (struct SwissHashTable *table, int capacity) {
+    int growth = (int) (table->maxLoadFactor * capacity);
+    return growth < capacity ? growth : capacity - 1;
+}
+
+/**
+ * Allocates empty control bytes and entries for the given number of slots
+ * @param table The table to allocate for
+ * @param capacity The number of slots, a power of two no less than SWISS_GROUP_WIDTH
+ */
+void allocateSwissSlots (struct SwissHashTable *table, int capacity) {
+    table->capacity = capacity;
+    table->control = malloc(capacity + SWISS_GROUP_WIDTH);
+    memset(table->control, SWISS_EMPTY, capacity + SWISS_GROUP_WIDTH);
+    table->entries = malloc(sizeof(struct SwissEntry) * capacity); // only read once a slot's control byte says it is full
+    table->growthLeft = maxSwissGrowth(table, capacity) - table->numEntries;
+}
+
+/**
+ * A function that creates a SwissTable style hashtable
+ * @param capacity The number of slots to start with, rounded up to a power of two of at least SWISS_GROUP_WIDTH
+ * @param maxLoadFactor The fraction of slots that can be filled before the table is resized, between 0 and 1
+ * @param hashFunction The function used to hash keys, 0 for wyHash
+ * @return The constructed SwissHashTable struct.
+ */
+struct SwissHashTable* constructSwissHashTable (int capacity, double maxLoadFactor, HashFunction hashFunction) {
+    struct SwissHashTable *table = malloc(sizeof(struct SwissHashTable));
+    table->numEntries = 0;
+    table->maxLoadFactor = maxLoadFactor > 0 && maxLoadFactor < 1 ? maxLoadFactor : 0.875; // the same as Abseil
+    table->hashFunction = hashFunction != 0 ? hashFunction : wyHash;
+    table->seed = randomSeed();
+    allocateSwissSlots(table, roundUpToPowerOfTwo(capacity > SWISS_GROUP_WIDTH ? capacity : SWISS_GROUP_WIDTH));
+    return table;
+}
+
+/**
+ * A function to delete and free the memory of a SwissTable style hashtable
+ * @param table The table to delete
+ */
+void destroySwissHashTable (struct SwissHashTable *table) {
+    free(table->control);
+    free(table->entries);
+    free(table);
+}
+
+/**
+ * Gets the current load factor of the table, the fraction of slots that are filled
+ * @param table The table to get the load factor of
+ * @return The load factor
+ */
+double getSwissLoadFactor (struct SwissHashTable *table) {
+    return (double) table->numEntries / table->capacity;
+}
+
+/**
+ * Sets the control byte of a slot, keeping the copy of the first group after the last slot up to date
+ * @param table The table the slot is in
+ * @param index The index of the slot
+ * @param control The control byte
+ */
+void setSwissControl (struct SwissHashTable *table, int index, int8_t control) {
+    table->control[index] = control;
+    if (index < SWISS_GROUP_WIDTH) {
+        table->control[table->capacity + index] = control;
+    }
+}
+
+/**
+ * Finds the first free slot in the probe sequence of a hash. Groups are probed in a triangular sequence, which visits
+ * every group once when the capacity is a power of two.
+ * @param table The table to look in
+ * @param mixed The mixed hash of the key
+ * @return The index of the slot
+ */
+int findFreeSwissSlot (struct SwissHashTable *table, uint64_t mixed) {
+    int mask = table->capacity - 1;
+    int position = (int) ((mixed >> 7) & (uint64_t) mask);
+    for (int step = SWISS_GROUP_WIDTH; ; step += SWISS_GROUP_WIDTH) {
+        uint32_t freeSlots = matchFreeSlot(&table->control[position]);
+        if (freeSlots != 0) {
+            return (position + __builtin_ctz(freeSlots)) & mask;
+        }
+        position = (position + step) & mask;
+    }
+}
+
+/**
+ * Moves every entry into a new set of slots, dropping the deleted slots. The table doubles in size unless removing
+ * has left it at most half full, in which case it stays the same size and only the deleted slots are reclaimed.
+ * @param table The table to resize
+ */
+void resizeSwissTable (struct SwissHashTable *table) {
+    int8_t *oldControl = table->control;
+    struct SwissEntry *oldEntries = table->entries;
+    int oldCapacity = table->capacity;
+
+    int capacity = table->numEntries + 1 > maxSwissGrowth(table, oldCapacity) / 2 ? oldCapacity * 2 : oldCapacity;
+    allocateSwissSlots(table, capacity);
+    for (int i = 0; i < oldCapacity; i++) {
+        if (oldControl[i] >= 0) { // a full slot, place it again using the stored hash
+            uint64_t mixed = mixHash(oldEntries[i].hash);
+            int index = findFreeSwissSlot(table, mixed);
+            setSwissControl(table, index, (int8_t) (mixed & 0x7f));
+            table->entries[index] = oldEntries[i];
+        }
+    }
+    free(oldControl);
+    free(oldEntries);
+}
+
+/**
+ * Adds the given key-pair value to the table, resizing it first if there are no empty slots left to fill. The key
+ * doesn't need to be null terminated.
+ * @param table The table to add to
+ * @param key The key to add
+ * @param keyLength The length of the key in bytes
+ * @param value The corresponding value to add
+ */
+void addToSwissTableWithLength (struct SwissHashTable *table, char *key, uint32_t keyLength, int value) {
+    if (table->growthLeft <= 0) {
+        resizeSwissTable(table);
+    }
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    uint64_t mixed = mixHash(keyHash);
+    int index = findFreeSwissSlot(table, mixed);
+    if (table->control[index] == SWISS_EMPTY) { // reusing a deleted slot doesn't use up an empty one
+        table->growthLeft--;
+    }
+    setSwissControl(table, index, (int8_t) (mixed & 0x7f)); // the low 7 bits, the high bits pick the group
+    struct SwissEntry *entry = &table->entries[index];
+    entry->key = key;
+    entry->keyLength = keyLength;
+    entry->hash = keyHash;
+    entry->value = value;
+    table->numEntries++;
+}
+
+/**
+ * Adds the given key-pair value to the table, resizing it first if there are no empty slots left to fill
+ * @param table The table to add to
+ * @param key The key to add
+ * @param value The corresponding value to add
+ */
+void addToSwissTable (struct SwissHashTable *table, char *key, int value) {
+    addToSwissTableWithLength(table, key, strlen(key), value);
+}
+
+/**
+ * Finds the index of the slot holding a key. Only the entries whose control byte matches the key's hash bits are
+ * compared, and the search stops at the first group with an empty slot since the key would have been put there.
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The index of the slot with the key in it, -1 if it can't be found
+ */
+int findSwissIndex (struct SwissHashTable *table, char *key, uint32_t keyLength) {
+    uint64_t keyHash = table->hashFunction(key, keyLength, table->seed);
+    uint64_t mixed = mixHash(keyHash);
+    int8_t control = (int8_t) (mixed & 0x7f);
+    int mask = table->capacity - 1;
+    int position = (int) ((mixed >> 7) & (uint64_t) mask);
+    for (int step = SWISS_GROUP_WIDTH; ; step += SWISS_GROUP_WIDTH) {
+        const int8_t *group = &table->control[position];
+        for (uint32_t matches = matchControlByte(group, control); matches != 0; matches &= matches - 1) {
+            int index = (position + __builtin_ctz(matches)) & mask;
+            struct SwissEntry *entry = &table->entries[index];
+            if (entry->hash == keyHash && entry->keyLength == keyLength && (entry->key == key || memcmp(entry->key, key, keyLength) == 0)) {
+                return index;
+            }
+        }
+        if (matchControlByte(group, SWISS_EMPTY) != 0) {
+            return -1;
+        }
+        position = (position + step) & mask;
+    }
+}
+
+/**
+ * Searches the table for a key, the key doesn't need to be null terminated
+ * @param table The table to search through
+ * @param key The key to search for
+ * @param keyLength The length of the key in bytes
+ * @return The entry the key is in, 0 if it can't be found
+ */
+struct SwissEntry* searchSwissTableWithLength (struct SwissHashTable *table, char *key, uint32_t keyLength) {
+    int index = findSwissIndex(table, key, keyLength);
+    return index >= 0 ? &table->entries[index] : 0;
+}
+
+/**
+ * Searches the table for a key
+ * @param table The table to search through
+ * @param key The key to search for
+ * @return The entry the key is in, 0 if it can't be found
+ */
+struct SwissEntry* searchSwissTable (struct SwissHashTable *table, char *key) {
+    return searchSwissTableWithLength(table, key, strlen(key));
+}
+
+/**
+ * A function to remove the key from the table. The slot can go straight back to empty if no probe could have passed
+ * over it, which is the case when there is an empty slot within a group's width either side of it. Otherwise it is
+ * marked deleted so searches carry on past it. The key doesn't need to be null terminated.
+ * @param table The table to remove the key from.
+ * @param key The key to remove.
+ * @param keyLength The length of the key in bytes.
+ */
+void removeFromSwissTableWithLength (struct SwissHashTable *table, char *key, uint32_t keyLength) {
+    int index = findSwissIndex(table, key, keyLength);
+    if (index < 0) return; // nothing to remove
+
+    uint32_t emptyBefore = matchControlByte(&table->control[(index - SWISS_GROUP_WIDTH) & (table->capacity - 1)], SWISS_EMPTY);
+    uint32_t emptyAfter = matchControlByte(&table->control[index], SWISS_EMPTY);
+    int fullBefore = emptyBefore != 0 ? __builtin_clz(emptyBefore) - (32 - SWISS_GROUP_WIDTH) : SWISS_GROUP_WIDTH;
+    int fullAfter = emptyAfter != 0 ? __builtin_ctz(emptyAfter) : SWISS_GROUP_WIDTH;
+    if (fullBefore + fullAfter < SWISS_GROUP_WIDTH) { // no group could have been full across this slot
+        setSwissControl(table, index, SWISS_EMPTY);
+        table->growthLeft++;
+    } else {
+        setSwissControl(table, index, SWISS_DELETED);
+    }
+    table->numEntries--;
+}
+
+/**
+ * A function to remove the key from the table.
+ * @param table The table to remove the key from.
+ * @param key The key to remove.
+ */
+void removeFromSwissTable (struct SwissHashTable *table, char *key) {
+    removeFromSwissTableWithLength(table, key, strlen(key));
+}
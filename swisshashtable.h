@@ -0,0 +1,50 @@
+#ifndef SWISSHASHTABLE_H
+#define SWISSHASHTABLE_H
+
+#include <stdint.h>
+
+#include "hash.h"
+
+#define SWISS_GROUP_WIDTH 16 // the number of control bytes probed at once
+#define SWISS_EMPTY ((int8_t) -128) // the control byte of a slot that has never been filled since the last resize
+#define SWISS_DELETED ((int8_t) -2) // the control byte of a slot whose entry was removed
+
+
+/**
+ * SwissEntry struct, stores a key-value pair in the table's entry array along with the hash of the key
+ */
+struct SwissEntry {
+    char *key; // holds a char array representing the key, not necessarily null terminated
+    uint64_t hash; // holds the hash of the key so it doesn't need recomputing when resizing
+    uint32_t keyLength; // holds the length of the key in bytes
+    int value; // holds the value associated with the key
+};
+
+/**
+ * SwissHashTable struct, an open addressing hashtable in the style of Abseil's SwissTable. Every slot has a control
+ * byte, either SWISS_EMPTY, SWISS_DELETED, or 7 bits of the key's hash when it is filled. Slots are probed a group of
+ * SWISS_GROUP_WIDTH at a time by comparing all of their control bytes at once with SIMD, so only the entries whose
+ * hash bits match are ever read, and a lookup for a missing key usually ends without touching an entry at all.
+ */
+struct SwissHashTable {
+    int capacity; // holds the number of slots, a power of two no less than SWISS_GROUP_WIDTH
+    int numEntries; // holds the number of key-value pairs stored in the table
+    int growthLeft; // holds the number of empty slots that can still be filled before the table is resized
+    double maxLoadFactor; // holds the fraction of slots that can be filled or deleted before the table is resized
+    HashFunction hashFunction; // holds the function used to hash keys
+    uint64_t seed; // holds the seed passed to the hash function, random for every table
+    int8_t *control; // holds a control byte per slot then a copy of the first group, so a group can be read past the end
+    struct SwissEntry *entries; // holds the array of entries
+};
+
+struct SwissHashTable* constructSwissHashTable (int capacity, double maxLoadFactor, HashFunction hashFunction);
+void destroySwissHashTable (struct SwissHashTable *table);
+double getSwissLoadFactor (struct SwissHashTable *table);
+void addToSwissTableWithLength (struct SwissHashTable *table, char *key, uint32_t keyLength, int value);
+void addToSwissTable (struct SwissHashTable *table, char *key, int value);
+struct SwissEntry* searchSwissTableWithLength (struct SwissHashTable *table, char *key, uint32_t keyLength);
+struct SwissEntry* searchSwissTable (struct SwissHashTable *table, char *key);
+void removeFromSwissTableWithLength (struct SwissHashTable *table, char *key, uint32_t keyLength);
+void removeFromSwissTable (struct SwissHashTable *table, char *key);
+
+#endif // SWISSHASHTABLE_H
@@ -0,0 +1,341 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "writebuffer.h"
+
+
+/**
+ * A function that creates an empty write buffer in front of a table
+ * @param table The table the writes are applied to, it must intern its keys since the buffer's copies are reused
+ * @param lock The lock guarding the table if other threads use it too, 0 otherwise
+ * @return The constructed WriteBuffer struct, 0 if the table doesn't intern its keys
+ */
+struct WriteBuffer* constructWriteBuffer (struct HashTable *table, pthread_mutex_t *lock) {
+    if (table->keyPool == 0) return 0; // its keys would point into the buffer, which is reused after every flush
+    struct WriteBuffer *buffer = malloc(sizeof(struct WriteBuffer));
+    buffer->table = table;
+    buffer->lock = lock;
+    buffer->seed = randomSeed();
+    buffer->numStaged = 0;
+    buffer->keyBytesUsed = 0;
+    memset(buffer->slots, 0xff, sizeof(buffer->slots)); // every byte 0xff makes every slot -1
+    return buffer;
+}
+
+/**
+ * A function to flush a write buffer and free it
+ * @param buffer The buffer to destroy
+ */
+void destroyWriteBuffer (struct WriteBuffer *buffer) {
+    flushWriteBuffer(buffer);
+    free(buffer);
+}
+
+/**
+ * Finds the slot of the buffer's index that holds a key, or the empty slot it would go in
+ * @param buffer The buffer to look in
+ * @param key The key
+ * @param keyLength The length of the key in bytes
+ * @param keyHash The hash of the key in the buffer's index
+ * @return The position of the slot
+ */
+int findStagedSlot (struct WriteBuffer *buffer, char *key, uint32_t keyLength, uint64_t keyHash) {
+    int position = (int) (keyHash & (WRITE_BUFFER_SLOTS - 1));
+    while (buffer->slots[position] >= 0) { // there is always an empty slot, the index is never more than half full
+        struct StagedWrite *write = &buffer->staged[buffer->slots[position]];
+        if (write->hash == keyHash && write->keyLength == keyLength && memcmp(buffer->keyBytes + write->keyOffset, key, keyLength) == 0) {
+            break;
+        }
+        position = (position + 1) & (WRITE_BUFFER_SLOTS - 1);
+    }
+    return position;
+}
+
+/**
+ * Applies one write to a table
+ * @param table The table to apply the write to
+ * @param key The key
+ * @param keyLength The length of the key in bytes
+ * @param keyHash The hash of the key in the table
+ * @param value The value to store, or the amount to add
+ * @param replace Whether to store the value rather than add it
+ * @return 1 if the write was applied, 0 if the key wasn't in the table and its key pool was too full to add it
+ */
+int applyWrite (struct HashTable *table, char *key, uint32_t keyLength, uint64_t keyHash, int value, int replace) {
+    int *stored = getOrInsertWithHash(table, key, keyLength, keyHash, replace ? value : 0);
+    if (stored == 0) return 0;
+    if (replace) {
+        *stored = value;
+    } else {
+        *stored += value;
+    }
+    return 1;
+}
+
+/**
+ * Orders staged writes by the bucket of the table they belong in
+ * @param a The first write
+ * @param b The second write
+ * @return Less than, equal to or greater than 0 as the first write's bucket comes before, with or after the second's
+ */
+int compareStagedBuckets (const void *a, const void *b) {
+    const struct StagedWrite *first = a;
+    const struct StagedWrite *second = b;
+    return (first->bucket > second->bucket) - (first->bucket < second->bucket);
+}
+
+/**
+ * Works out where a key's top level bucket is for sorting, the same way locateBucket finds it. While the table is
+ * growing a key whose bucket has been migrated is in the new array, which is counted after the old one.
+ * @param table The table the key is going into
+ * @param keyHash The hash of the key in the table
+ * @return The position of the key's top level bucket, over both arrays while the table is growing
+ */
+long stagedBucket (struct HashTable *table, uint64_t keyHash) {
+    int boundedHash = bucketIndex(table, keyHash, table->numBuckets);
+    if (table->newBuckets != 0 && boundedHash < table->rehashIndex) {
+        return (long) table->numBuckets + bucketIndex(table, keyHash, table->numNewBuckets);
+    }
+    return boundedHash;
+}
+
+/**
+ * Works out the table's hash and the position of the top level bucket of each staged write from the given one on, and
+ * sorts them by that position
+ * @param buffer The buffer being flushed
+ * @param start The index of the first staged write to sort
+ */
+void sortStagedWrites (struct WriteBuffer *buffer, int start) {
+    struct HashTable *table = buffer->table;
+    for (int i = start; i < buffer->numStaged; i++) {
+        struct StagedWrite *write = &buffer->staged[i];
+        write->hash = table->hashFunction(buffer->keyBytes + write->keyOffset, write->keyLength, table->seed);
+        write->bucket = stagedBucket(table, write->hash);
+    }
+    qsort(buffer->staged + start, buffer->numStaged - start, sizeof(struct StagedWrite), compareStagedBuckets);
+}
+
+/**
+ * Applies a run of staged writes whose keys all belong in the same top level bucket, walking its chain once for all of
+ * them. The keys found on the way are written in place, and the rest are then chained onto the front of the bucket.
+ * @param buffer The buffer being flushed
+ * @param start The index of the first staged write of the run
+ * @param end The index after the last staged write of the run
+ * @return The number of keys written to the table, less than the run if the table's key pool filled up
+ */
+int applyStagedRun (struct WriteBuffer *buffer, int start, int end) {
+    struct HashTable *table = buffer->table;
+    struct StagedWrite *run = &buffer->staged[start];
+    int runLength = end - start;
+    struct Bucket **chain = locateBucket(table, run[0].hash);
+
+    int numFound = 0;
+    int probes = 0;
+    for (struct Bucket *bucket = *chain; bucket != 0 && numFound < runLength; bucket = bucket->chainedBucket) {
+        probes++;
+        for (int i = 0; i < runLength; i++) {
+            struct StagedWrite *write = &run[i];
+            if (write->bucket >= 0 && bucketHasKey(bucket, buffer->keyBytes + write->keyOffset, write->keyLength, write->hash)) {
+                bucket->value = write->replace ? write->value : bucket->value + write->value;
+                write->bucket = -1; // written, the rest of the chain can't hold it again for this write
+                numFound++;
+                RECORD_PROBES(table, probes, 1);
+                break;
+            }
+        }
+    }
+
+    int numWritten = numFound;
+    for (int i = 0; i < runLength && numFound < runLength; i++) { // the keys the chain doesn't hold yet
+        struct StagedWrite *write = &run[i];
+        if (write->bucket < 0) continue;
+        RECORD_PROBES(table, probes, 0);
+        char *owned = ownKey(table, buffer->keyBytes + write->keyOffset, write->keyLength, 0);
+        if (owned == 0) continue; // the pool is full, the write is dropped
+        *chain = chainValue(&table->bucketPool, *chain, owned, write->keyLength, write->hash, write->value);
+        table->numEntries++;
+        COUNT_STAT(table, inserts, 1);
+        numWritten++;
+    }
+    checkChainLength(table, probes + runLength - numFound);
+    return numWritten;
+}
+
+/**
+ * Applies every staged write to the table and empties the buffer. The writes are sorted by the bucket they belong in
+ * first, in whichever array it is in while the table is growing, and each run of writes to the same bucket is applied
+ * with one walk of its chain. The buckets the writes would each have migrated are migrated before sorting, and the
+ * table is only allowed to start growing after the last write, so the order can't go stale part way through unless a
+ * long chain makes the table rehash, after which the writes left are sorted again.
+ * @param buffer The buffer to flush
+ * @return The number of keys written to the table, less than were staged if the table's key pool filled up, in which
+ *         case the writes of the keys it had no room for are dropped
+ */
+int flushWriteBuffer (struct WriteBuffer *buffer) {
+    int numStaged = buffer->numStaged;
+    if (numStaged == 0) return 0;
+    struct HashTable *table = buffer->table;
+    if (buffer->lock != 0) {
+        pthread_mutex_lock(buffer->lock);
+    }
+
+    migrateBuckets(table, table->rehashStep * numStaged);
+    sortStagedWrites(buffer, 0); // under the lock, another thread's flush may have rehashed the table
+    HashFunction hashFunction = table->hashFunction;
+    uint64_t seed = table->seed;
+    int numWritten = 0;
+    for (int start = 0; start < numStaged; ) {
+        if (table->hashFunction != hashFunction || table->seed != seed) { // a long chain made the table rehash part way through
+            sortStagedWrites(buffer, start);
+            hashFunction = table->hashFunction;
+            seed = table->seed;
+        }
+        int end = start + 1;
+        while (end < numStaged && buffer->staged[end].bucket == buffer->staged[start].bucket) {
+            end++;
+        }
+        numWritten += applyStagedRun(buffer, start, end);
+        start = end;
+    }
+    growIfNeeded(table);
+
+    if (buffer->lock != 0) {
+        pthread_mutex_unlock(buffer->lock);
+    }
+    buffer->numStaged = 0;
+    buffer->keyBytesUsed = 0;
+    memset(buffer->slots, 0xff, sizeof(buffer->slots));
+    return numWritten;
+}
+
+/**
+ * Stages a write, merging it into the staged write of the same key if there is one. The buffer is flushed first if it
+ * has no room for another key, and a key too long for the buffer at all is applied straight away.
+ * @param buffer The buffer to stage the write in
+ * @param key The key
+ * @param keyLength The length of the key in bytes
+ * @param value The value to store, or the amount to add
+ * @param replace Whether to store the value rather than add it
+ */
+void stageWrite (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int value, int replace) {
+    if (keyLength > WRITE_BUFFER_KEY_BYTES) {
+        if (buffer->lock != 0) pthread_mutex_lock(buffer->lock);
+        applyWrite(buffer->table, key, keyLength, buffer->table->hashFunction(key, keyLength, buffer->table->seed), value, replace);
+        if (buffer->lock != 0) pthread_mutex_unlock(buffer->lock);
+        return;
+    }
+
+    uint64_t keyHash = wyHash(key, keyLength, buffer->seed);
+    int position = findStagedSlot(buffer, key, keyLength, keyHash);
+    if (buffer->slots[position] >= 0) { // merge with the writes already staged
+        struct StagedWrite *write = &buffer->staged[buffer->slots[position]];
+        if (replace) {
+            write->value = value;
+            write->replace = 1;
+        } else {
+            write->value += value;
+        }
+        return;
+    }
+
+    if (buffer->numStaged == WRITE_BUFFER_CAPACITY || keyLength > WRITE_BUFFER_KEY_BYTES - buffer->keyBytesUsed) {
+        flushWriteBuffer(buffer);
+        position = findStagedSlot(buffer, key, keyLength, keyHash);
+    }
+    struct StagedWrite *write = &buffer->staged[buffer->numStaged];
+    write->keyOffset = buffer->keyBytesUsed;
+    write->keyLength = keyLength;
+    write->hash = keyHash;
+    write->value = value;
+    write->replace = replace;
+    memcpy(buffer->keyBytes + buffer->keyBytesUsed, key, keyLength);
+    buffer->keyBytesUsed += keyLength;
+    buffer->slots[position] = (int16_t) buffer->numStaged++;
+}
+
+/**
+ * Stages setting the value of a key, the key doesn't need to be null terminated or to stay in memory
+ * @param buffer The buffer to stage the write in
+ * @param key The key to set the value of
+ * @param keyLength The length of the key in bytes
+ * @param value The value to store
+ */
+void bufferUpsertWithLength (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int value) {
+    stageWrite(buffer, key, keyLength, value, 1);
+}
+
+/**
+ * Stages setting the value of a key
+ * @param buffer The buffer to stage the write in
+ * @param key The key to set the value of
+ * @param value The value to store
+ */
+void bufferUpsert (struct WriteBuffer *buffer, char *key, int value) {
+    bufferUpsertWithLength(buffer, key, strlen(key), value);
+}
+
+/**
+ * Stages adding to the value of a key, a key that isn't in the table is added with the total of its deltas. The key
+ * doesn't need to be null terminated or to stay in memory.
+ * @param buffer The buffer to stage the write in
+ * @param key The key to add to the value of
+ * @param keyLength The length of the key in bytes
+ * @param delta The amount to add
+ */
+void bufferIncrementWithLength (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int delta) {
+    stageWrite(buffer, key, keyLength, delta, 0);
+}
+
+/**
+ * Stages adding to the value of a key
+ * @param buffer The buffer to stage the write in
+ * @param key The key to add to the value of
+ * @param delta The amount to add
+ */
+void bufferIncrement (struct WriteBuffer *buffer, char *key, int delta) {
+    bufferIncrementWithLength(buffer, key, strlen(key), delta);
+}
+
+/**
+ * Finds the value of a key as it will be once the buffer is flushed, combining the buffer's staged write with the
+ * table. A key given a value outright is answered from the buffer alone. Writes staged in other threads' buffers
+ * aren't seen until they are flushed.
+ * @param buffer The buffer to look in
+ * @param key The key to search for, not necessarily null terminated
+ * @param keyLength The length of the key in bytes
+ * @param value Set to the value of the key if it is found
+ * @return 1 if the key was found in the buffer or the table, 0 otherwise
+ */
+int searchWriteBufferWithLength (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int *value) {
+    struct StagedWrite *write = 0;
+    if (keyLength <= WRITE_BUFFER_KEY_BYTES) {
+        int position = findStagedSlot(buffer, key, keyLength, wyHash(key, keyLength, buffer->seed));
+        if (buffer->slots[position] >= 0) {
+            write = &buffer->staged[buffer->slots[position]];
+        }
+    }
+    if (write != 0 && write->replace) {
+        *value = write->value;
+        return 1;
+    }
+
+    if (buffer->lock != 0) pthread_mutex_lock(buffer->lock);
+    struct Bucket *bucket = searchTableWithLength(buffer->table, key, keyLength);
+    int stored = bucket != 0 ? bucket->value : 0;
+    if (buffer->lock != 0) pthread_mutex_unlock(buffer->lock);
+
+    if (bucket == 0 && write == 0) return 0;
+    *value = stored + (write != 0 ? write->value : 0);
+    return 1;
+}
+
+/**
+ * Finds the value of a key as it will be once the buffer is flushed
+ * @param buffer The buffer to look in
+ * @param key The key to search for
+ * @param value Set to the value of the key if it is found
+ * @return 1 if the key was found in the buffer or the table, 0 otherwise
+ */
+int searchWriteBuffer (struct WriteBuffer *buffer, char *key, int *value) {
+    return searchWriteBufferWithLength(buffer, key, strlen(key), value);
+}
@@ -0,0 +1,54 @@
+#ifndef WRITEBUFFER_H
+#define WRITEBUFFER_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "hashtable.h"
+
+#define WRITE_BUFFER_CAPACITY 256 // the number of distinct keys staged before the buffer flushes itself
+#define WRITE_BUFFER_SLOTS 512 // the number of slots of the buffer's own index, a power of two at least twice the capacity
+#define WRITE_BUFFER_KEY_BYTES 16384 // the bytes of staged keys held before the buffer flushes itself
+
+
+/**
+ * StagedWrite struct, every write to one key since the last flush merged into one
+ */
+struct StagedWrite {
+    uint32_t keyOffset; // holds the offset of the key in the buffer's key bytes
+    uint32_t keyLength; // holds the length of the key in bytes
+    uint64_t hash; // holds the key's hash in the buffer's index, then its hash in the table while flushing
+    int value; // holds the value to store, or the total to add when replace isn't set
+    int replace; // holds whether the key was given a value outright, rather than only added to
+    long bucket; // holds where the key's top level bucket is when flushing, a growing table's new array counted after the old, -1 once written
+};
+
+/**
+ * WriteBuffer struct, stages upserts and increments in front of a HashTable so each key is only hashed and searched
+ * for in the table once per flush however many times it was written. A full buffer flushes itself, applying the writes
+ * in order of bucket so each chain is walked once, and reads look in the buffer as well as the table so a flush is
+ * never needed to see a write. A buffer belongs to one thread, and threads sharing a table each have their own and
+ * share a lock that the buffers only take while flushing or reading the table.
+ */
+struct WriteBuffer {
+    struct HashTable *table; // holds the table the writes are applied to, it must intern its keys
+    pthread_mutex_t *lock; // holds the lock guarding the table, 0 if only one thread uses it
+    uint64_t seed; // holds the seed of the buffer's own index, separate from the table's so reading it needs no lock
+    int numStaged; // holds the number of keys staged
+    struct StagedWrite staged[WRITE_BUFFER_CAPACITY]; // holds the staged writes in the order their keys were first written
+    int16_t slots[WRITE_BUFFER_SLOTS]; // holds the index of a staged write per slot, -1 for an empty slot, probed linearly
+    uint32_t keyBytesUsed; // holds the number of bytes of keyBytes in use
+    char keyBytes[WRITE_BUFFER_KEY_BYTES]; // holds a copy of every staged key
+};
+
+struct WriteBuffer* constructWriteBuffer (struct HashTable *table, pthread_mutex_t *lock);
+void destroyWriteBuffer (struct WriteBuffer *buffer);
+int flushWriteBuffer (struct WriteBuffer *buffer);
+void bufferUpsertWithLength (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int value);
+void bufferUpsert (struct WriteBuffer *buffer, char *key, int value);
+void bufferIncrementWithLength (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int delta);
+void bufferIncrement (struct WriteBuffer *buffer, char *key, int delta);
+int searchWriteBufferWithLength (struct WriteBuffer *buffer, char *key, uint32_t keyLength, int *value);
+int searchWriteBuffer (struct WriteBuffer *buffer, char *key, int *value);
+
+#endif // WRITEBUFFER_H